@@ -49,14 +49,111 @@ const int MoveDelta[6][8] = {
     { -11, -10,  -9,  -1,   1,   9,  10,  11 }  // King
 };
 
-U64 BB_KnightAttack[64];
-U64 BB_KingAttack[64];
+// Knight and King attack tables (precomputed)
+
+const U64 BB_KnightAttack[64] = {
+    0x0000000000020400ULL, 0x0000000000050800ULL, 0x00000000000A1100ULL, 0x0000000000142200ULL,
+    0x0000000000284400ULL, 0x0000000000508800ULL, 0x0000000000A01000ULL, 0x0000000000402000ULL,
+    0x0000000002040004ULL, 0x0000000005080008ULL, 0x000000000A110011ULL, 0x0000000014220022ULL,
+    0x0000000028440044ULL, 0x0000000050880088ULL, 0x00000000A0100010ULL, 0x0000000040200020ULL,
+    0x0000000204000402ULL, 0x0000000508000805ULL, 0x0000000A1100110AULL, 0x0000001422002214ULL,
+    0x0000002844004428ULL, 0x0000005088008850ULL, 0x000000A0100010A0ULL, 0x0000004020002040ULL,
+    0x0000020400040200ULL, 0x0000050800080500ULL, 0x00000A1100110A00ULL, 0x0000142200221400ULL,
+    0x0000284400442800ULL, 0x0000508800885000ULL, 0x0000A0100010A000ULL, 0x0000402000204000ULL,
+    0x0002040004020000ULL, 0x0005080008050000ULL, 0x000A1100110A0000ULL, 0x0014220022140000ULL,
+    0x0028440044280000ULL, 0x0050880088500000ULL, 0x00A0100010A00000ULL, 0x0040200020400000ULL,
+    0x0204000402000000ULL, 0x0508000805000000ULL, 0x0A1100110A000000ULL, 0x1422002214000000ULL,
+    0x2844004428000000ULL, 0x5088008850000000ULL, 0xA0100010A0000000ULL, 0x4020002040000000ULL,
+    0x0400040200000000ULL, 0x0800080500000000ULL, 0x1100110A00000000ULL, 0x2200221400000000ULL,
+    0x4400442800000000ULL, 0x8800885000000000ULL, 0x100010A000000000ULL, 0x2000204000000000ULL,
+    0x0004020000000000ULL, 0x0008050000000000ULL, 0x00110A0000000000ULL, 0x0022140000000000ULL,
+    0x0044280000000000ULL, 0x0088500000000000ULL, 0x0010A00000000000ULL, 0x0020400000000000ULL
+};
+
+const U64 BB_KingAttack[64] = {
+    0x0000000000000302ULL, 0x0000000000000705ULL, 0x0000000000000E0AULL, 0x0000000000001C14ULL,
+    0x0000000000003828ULL, 0x0000000000007050ULL, 0x000000000000E0A0ULL, 0x000000000000C040ULL,
+    0x0000000000030203ULL, 0x0000000000070507ULL, 0x00000000000E0A0EULL, 0x00000000001C141CULL,
+    0x0000000000382838ULL, 0x0000000000705070ULL, 0x0000000000E0A0E0ULL, 0x0000000000C040C0ULL,
+    0x0000000003020300ULL, 0x0000000007050700ULL, 0x000000000E0A0E00ULL, 0x000000001C141C00ULL,
+    0x0000000038283800ULL, 0x0000000070507000ULL, 0x00000000E0A0E000ULL, 0x00000000C040C000ULL,
+    0x0000000302030000ULL, 0x0000000705070000ULL, 0x0000000E0A0E0000ULL, 0x0000001C141C0000ULL,
+    0x0000003828380000ULL, 0x0000007050700000ULL, 0x000000E0A0E00000ULL, 0x000000C040C00000ULL,
+    0x0000030203000000ULL, 0x0000070507000000ULL, 0x00000E0A0E000000ULL, 0x00001C141C000000ULL,
+    0x0000382838000000ULL, 0x0000705070000000ULL, 0x0000E0A0E0000000ULL, 0x0000C040C0000000ULL,
+    0x0003020300000000ULL, 0x0007050700000000ULL, 0x000E0A0E00000000ULL, 0x001C141C00000000ULL,
+    0x0038283800000000ULL, 0x0070507000000000ULL, 0x00E0A0E000000000ULL, 0x00C040C000000000ULL,
+    0x0302030000000000ULL, 0x0705070000000000ULL, 0x0E0A0E0000000000ULL, 0x1C141C0000000000ULL,
+    0x3828380000000000ULL, 0x7050700000000000ULL, 0xE0A0E00000000000ULL, 0xC040C00000000000ULL,
+    0x0203000000000000ULL, 0x0507000000000000ULL, 0x0A0E000000000000ULL, 0x141C000000000000ULL,
+    0x2838000000000000ULL, 0x5070000000000000ULL, 0xA0E0000000000000ULL, 0x40C0000000000000ULL
+};
+
+// Bishop and Rook mask tables without board edges (precomputed)
+
+const U64 BB_BishopMask[64] = {
+    0x0040201008040200ULL, 0x0000402010080400ULL, 0x0000004020100A00ULL, 0x0000000040221400ULL,
+    0x0000000002442800ULL, 0x0000000204085000ULL, 0x0000020408102000ULL, 0x0002040810204000ULL,
+    0x0020100804020000ULL, 0x0040201008040000ULL, 0x00004020100A0000ULL, 0x0000004022140000ULL,
+    0x0000000244280000ULL, 0x0000020408500000ULL, 0x0002040810200000ULL, 0x0004081020400000ULL,
+    0x0010080402000200ULL, 0x0020100804000400ULL, 0x004020100A000A00ULL, 0x0000402214001400ULL,
+    0x0000024428002800ULL, 0x0002040850005000ULL, 0x0004081020002000ULL, 0x0008102040004000ULL,
+    0x0008040200020400ULL, 0x0010080400040800ULL, 0x0020100A000A1000ULL, 0x0040221400142200ULL,
+    0x0002442800284400ULL, 0x0004085000500800ULL, 0x0008102000201000ULL, 0x0010204000402000ULL,
+    0x0004020002040800ULL, 0x0008040004081000ULL, 0x00100A000A102000ULL, 0x0022140014224000ULL,
+    0x0044280028440200ULL, 0x0008500050080400ULL, 0x0010200020100800ULL, 0x0020400040201000ULL,
+    0x0002000204081000ULL, 0x0004000408102000ULL, 0x000A000A10204000ULL, 0x0014001422400000ULL,
+    0x0028002844020000ULL, 0x0050005008040200ULL, 0x0020002010080400ULL, 0x0040004020100800ULL,
+    0x0000020408102000ULL, 0x0000040810204000ULL, 0x00000A1020400000ULL, 0x0000142240000000ULL,
+    0x0000284402000000ULL, 0x0000500804020000ULL, 0x0000201008040200ULL, 0x0000402010080400ULL,
+    0x0002040810204000ULL, 0x0004081020400000ULL, 0x000A102040000000ULL, 0x0014224000000000ULL,
+    0x0028440200000000ULL, 0x0050080402000000ULL, 0x0020100804020000ULL, 0x0040201008040200ULL
+};
+
+const U64 BB_RookMask[64] = {
+    0x000101010101017EULL, 0x000202020202027CULL, 0x000404040404047AULL, 0x0008080808080876ULL,
+    0x001010101010106EULL, 0x002020202020205EULL, 0x004040404040403EULL, 0x008080808080807EULL,
+    0x0001010101017E00ULL, 0x0002020202027C00ULL, 0x0004040404047A00ULL, 0x0008080808087600ULL,
+    0x0010101010106E00ULL, 0x0020202020205E00ULL, 0x0040404040403E00ULL, 0x0080808080807E00ULL,
+    0x00010101017E0100ULL, 0x00020202027C0200ULL, 0x00040404047A0400ULL, 0x0008080808760800ULL,
+    0x00101010106E1000ULL, 0x00202020205E2000ULL, 0x00404040403E4000ULL, 0x00808080807E8000ULL,
+    0x000101017E010100ULL, 0x000202027C020200ULL, 0x000404047A040400ULL, 0x0008080876080800ULL,
+    0x001010106E101000ULL, 0x002020205E202000ULL, 0x004040403E404000ULL, 0x008080807E808000ULL,
+    0x0001017E01010100ULL, 0x0002027C02020200ULL, 0x0004047A04040400ULL, 0x0008087608080800ULL,
+    0x0010106E10101000ULL, 0x0020205E20202000ULL, 0x0040403E40404000ULL, 0x0080807E80808000ULL,
+    0x00017E0101010100ULL, 0x00027C0202020200ULL, 0x00047A0404040400ULL, 0x0008760808080800ULL,
+    0x00106E1010101000ULL, 0x00205E2020202000ULL, 0x00403E4040404000ULL, 0x00807E8080808000ULL,
+    0x007E010101010100ULL, 0x007C020202020200ULL, 0x007A040404040400ULL, 0x0076080808080800ULL,
+    0x006E101010101000ULL, 0x005E202020202000ULL, 0x003E404040404000ULL, 0x007E808080808000ULL,
+    0x7E01010101010100ULL, 0x7C02020202020200ULL, 0x7A04040404040400ULL, 0x7608080808080800ULL,
+    0x6E10101010101000ULL, 0x5E20202020202000ULL, 0x3E40404040404000ULL, 0x7E80808080808000ULL
+};
+
+// Bishop and Rook offsets into the attack tables (precomputed)
+
+const int BB_BishopOffset[64] = {
+         0,     64,     96,    128,    160,    192,    224,    256,
+       320,    352,    384,    416,    448,    480,    512,    544,
+       576,    608,    640,    768,    896,   1024,   1152,   1184,
+      1216,   1248,   1280,   1408,   1920,   2432,   2560,   2592,
+      2624,   2656,   2688,   2816,   3328,   3840,   3968,   4000,
+      4032,   4064,   4096,   4224,   4352,   4480,   4608,   4640,
+      4672,   4704,   4736,   4768,   4800,   4832,   4864,   4896,
+      4928,   4992,   5024,   5056,   5088,   5120,   5152,   5184
+};
 
-U64 BB_BishopMask[64];
-U64 BB_RookMask[64];
+const int BB_RookOffset[64] = {
+         0,   4096,   6144,   8192,  10240,  12288,  14336,  16384,
+     20480,  22528,  23552,  24576,  25600,  26624,  27648,  28672,
+     30720,  32768,  33792,  34816,  35840,  36864,  37888,  38912,
+     40960,  43008,  44032,  45056,  46080,  47104,  48128,  49152,
+     51200,  53248,  54272,  55296,  56320,  57344,  58368,  59392,
+     61440,  63488,  64512,  65536,  66560,  67584,  68608,  69632,
+     71680,  73728,  74752,  75776,  76800,  77824,  78848,  79872,
+     81920,  86016,  88064,  90112,  92160,  94208,  96256,  98304
+};
 
-int BB_BishopOffset[64];
-int BB_RookOffset[64];
+// Bishop and Rook attack tables (filled in InitBitBoards)
 
 U64 BB_BishopAttack[5248];
 U64 BB_RookAttack[102400];
@@ -142,64 +239,82 @@ U64 CalculatePieceAttack(const int Piece, const int Square, const U64 Occupied,
     return Result;
 }
 
-void InitAttackTable(const int Piece, const int Square, const U64* BB_Mask, int* BB_OffsetTable, U64* BB_AttackTable, int* Offset)
+void InitAttackTable(const int Piece, const int Square, const U64* BB_Mask, const int* BB_OffsetTable, U64* BB_AttackTable)
 {
     U64 Occupied;
 
     U64 Attack;
 
-#ifdef DEBUG_BIT_BOARD_INIT
-    U64 PreviousAttack;
-#endif // DEBUG_BIT_BOARD_INIT
-
     int CountBits = POPCNT(BB_Mask[Square]); // Max. 12 bits (example, rook on a1)
 
     int MaxIndex = 1 << CountBits; // Max. 4096 (1 << 12)
 
-    BB_OffsetTable[Square] = *Offset;
+    int Offset = BB_OffsetTable[Square];
 
     for (int Index = 0; Index < MaxIndex; ++Index) {
         Occupied = PDEP((U64)Index, BB_Mask[Square]);
 
         Attack = CalculatePieceAttack(Piece, Square, Occupied, FALSE);
 
+        BB_AttackTable[Offset + Index] = Attack;
+    }
+}
+
 #ifdef DEBUG_BIT_BOARD_INIT
-        PreviousAttack = BB_AttackTable[*Offset + Index];
+void CheckBitBoards(void)
+{
+    int BishopOffset = 0;
+    int RookOffset = 0;
 
-        if (PreviousAttack && PreviousAttack != Attack) {
-            if (Piece == BISHOP) {
-                printf("-- Bishop attack error!\n");
-            }
-            else { // Rook
-                printf("-- Rook attack error!\n");
-            }
+    for (int Square = 0; Square < 64; ++Square) {
+        if (BB_KnightAttack[Square] != CalculatePieceAttack(KNIGHT, Square, 0ULL, FALSE)) {
+            printf("-- Knight attack error (square %d)!\n", Square);
         }
-#endif // DEBUG_BIT_BOARD_INIT
 
-        BB_AttackTable[*Offset + Index] = Attack;
+        if (BB_KingAttack[Square] != CalculatePieceAttack(KING, Square, 0ULL, FALSE)) {
+            printf("-- King attack error (square %d)!\n", Square);
+        }
+
+        if (BB_BishopMask[Square] != CalculatePieceAttack(BISHOP, Square, 0ULL, TRUE)) {
+            printf("-- Bishop mask error (square %d)!\n", Square);
+        }
+
+        if (BB_RookMask[Square] != CalculatePieceAttack(ROOK, Square, 0ULL, TRUE)) {
+            printf("-- Rook mask error (square %d)!\n", Square);
+        }
+
+        if (BB_BishopOffset[Square] != BishopOffset) {
+            printf("-- Bishop offset error (square %d)!\n", Square);
+        }
+
+        if (BB_RookOffset[Square] != RookOffset) {
+            printf("-- Rook offset error (square %d)!\n", Square);
+        }
+
+        BishopOffset += 1 << POPCNT(BB_BishopMask[Square]);
+        RookOffset += 1 << POPCNT(BB_RookMask[Square]);
+    }
+
+    if (BishopOffset != (int)_countof(BB_BishopAttack)) {
+        printf("-- Bishop attack table size error!\n");
     }
 
-    *Offset += MaxIndex;
+    if (RookOffset != (int)_countof(BB_RookAttack)) {
+        printf("-- Rook attack table size error!\n");
+    }
 }
+#endif // DEBUG_BIT_BOARD_INIT
 
 void InitBitBoards(void)
 {
-    int BishopOffset = 0;
-    int RookOffset = 0;
-
-    // Init Bishop and Rook mask tables
-    for (int Square = 0; Square < 64; ++Square) {
-        BB_BishopMask[Square] = CalculatePieceAttack(BISHOP, Square, 0ULL, TRUE);
-        BB_RookMask[Square] = CalculatePieceAttack(ROOK, Square, 0ULL, TRUE);
-    }
+#ifdef DEBUG_BIT_BOARD_INIT
+    CheckBitBoards();
+#endif // DEBUG_BIT_BOARD_INIT
 
-    // Init Knight and King attack tables; Bishop and Rook offset and attack tables
+    // Init Bishop and Rook attack tables (masks and offsets are precomputed)
     for (int Square = 0; Square < 64; ++Square) {
-        BB_KnightAttack[Square] = CalculatePieceAttack(KNIGHT, Square, 0ULL, FALSE);
-        BB_KingAttack[Square] = CalculatePieceAttack(KING, Square, 0ULL, FALSE);
-
-        InitAttackTable(BISHOP, Square, BB_BishopMask, BB_BishopOffset, BB_BishopAttack, &BishopOffset);
-        InitAttackTable(ROOK, Square, BB_RookMask, BB_RookOffset, BB_RookAttack, &RookOffset);
+        InitAttackTable(BISHOP, Square, BB_BishopMask, BB_BishopOffset, BB_BishopAttack);
+        InitAttackTable(ROOK, Square, BB_RookMask, BB_RookOffset, BB_RookAttack);
     }
 }
 
@@ -11,6 +11,7 @@
 #include "Move.h"
 #include "NNUE2.h"
 #include "Types.h"
+#include "Utils.h"
 
 const char* BoardName[64] = {
     "a8", "b8", "c8", "d8", "e8", "f8", "g8", "h8",
@@ -59,7 +60,7 @@ BoardItem CurrentBoard;
 BoardItem ThreadBoardList[MAX_THREADS];
 
 #ifdef LATE_MOVE_PRUNING
-int LateMovePruningTable[7]; // [LMP depth]
+const int LateMovePruningTable[7] = { 3, 4, 6, 10, 14, 20, 26 }; // [LMP depth] round(2.98484 + pow(Depth, 1.74716)) (Hakkapeliitta)
 #endif // LATE_MOVE_PRUNING
 
 #ifdef LATE_MOVE_REDUCTION
@@ -105,13 +106,13 @@ BOOL IsInCheck(const BoardItem* Board, const int Color)
 BOOL HasLegalMoves(BoardItem* Board)
 {
     int GenMoveCount;
-    MoveItem MoveList[MAX_GEN_MOVES];
+    MoveListItem MoveList;
 
     GenMoveCount = 0;
-    GenerateAllMoves(Board, NULL, MoveList, &GenMoveCount);
+    GenerateAllMoves(Board, NULL, &MoveList, &GenMoveCount);
 
     for (int MoveNumber = 0; MoveNumber < GenMoveCount; ++MoveNumber) {
-        MakeMove(Board, MoveList[MoveNumber]);
+        MakeMove(Board, CreateMoveItem(Board, MoveList.Move[MoveNumber]));
 
         if (IsInCheck(Board, CHANGE_COLOR(Board->CurrentColor))) { // Illegal move
             UnmakeMove(Board);
@@ -139,7 +140,7 @@ void NotateMove(BoardItem* Board, const MoveItem Move, char* Result)
     int PieceTypeFrom = PIECE_TYPE(Board->Pieces[From]);
 
     int GenMoveCount;
-    MoveItem MoveList[MAX_GEN_MOVES];
+    MoveListItem MoveList;
 
     BOOL GiveCheck;
     BOOL LegalMoves = FALSE;
@@ -156,26 +157,26 @@ void NotateMove(BoardItem* Board, const MoveItem Move, char* Result)
     }
 
     GenMoveCount = 0;
-    GenerateAllMoves(Board, NULL, MoveList, &GenMoveCount);
+    GenerateAllMoves(Board, NULL, &MoveList, &GenMoveCount);
 
     for (int MoveNumber = 0; MoveNumber < GenMoveCount; ++MoveNumber) {
-        if (MOVE_TO(MoveList[MoveNumber].Move) != To) {
+        if (MOVE_TO(MoveList.Move[MoveNumber]) != To) {
             continue; // Next move
         }
 
-        if (MOVE_FROM(MoveList[MoveNumber].Move) == From) {
+        if (MOVE_FROM(MoveList.Move[MoveNumber]) == From) {
             continue; // Next move
         }
 
-        if (PIECE_TYPE(Board->Pieces[MOVE_FROM(MoveList[MoveNumber].Move)]) != PieceTypeFrom) {
+        if (PIECE_TYPE(Board->Pieces[MOVE_FROM(MoveList.Move[MoveNumber])]) != PieceTypeFrom) {
             continue; // Next move
         }
 
-        if ((MoveList[MoveNumber].Type & MOVE_PAWN_PROMOTE) && MOVE_PROMOTE_PIECE_TYPE(MoveList[MoveNumber].Move) != QUEEN) {
+        if (MOVE_PROMOTE_PIECE_TYPE(MoveList.Move[MoveNumber]) && MOVE_PROMOTE_PIECE_TYPE(MoveList.Move[MoveNumber]) != QUEEN) {
             continue; // Next move
         }
 
-        MakeMove(Board, MoveList[MoveNumber]);
+        MakeMove(Board, CreateMoveItem(Board, MoveList.Move[MoveNumber]));
 
         if (IsInCheck(Board, CHANGE_COLOR(Board->CurrentColor))) { // Illegal move
             UnmakeMove(Board);
@@ -185,11 +186,11 @@ void NotateMove(BoardItem* Board, const MoveItem Move, char* Result)
 
         Ambiguous = TRUE;
 
-        if (FILE(MOVE_FROM(MoveList[MoveNumber].Move)) == FILE(From)) {
+        if (FILE(MOVE_FROM(MoveList.Move[MoveNumber])) == FILE(From)) {
             AmbiguousFile = TRUE;
         }
 
-        if (RANK(MOVE_FROM(MoveList[MoveNumber].Move)) == RANK(From)) {
+        if (RANK(MOVE_FROM(MoveList.Move[MoveNumber])) == RANK(From)) {
             AmbiguousRank = TRUE;
         }
 
@@ -311,13 +312,212 @@ void NotateMove(BoardItem* Board, const MoveItem Move, char* Result)
     *Result = '\0'; // Nul
 }
 
+int ParseMove(BoardItem* Board, const char* MoveString)
+{
+    int Color = Board->CurrentColor;
+
+    U64 Occupied = Board->BB_WhitePieces | Board->BB_BlackPieces;
+    U64 Own = (Color == WHITE ? Board->BB_WhitePieces : Board->BB_BlackPieces);
+
+    int PieceType = PAWN;
+    int PromotePieceType = 0;
+
+    int FileFrom = -1;
+    int RankFrom = -1;
+
+    int From;
+    int To;
+
+    U64 Candidates;
+
+    int Move;
+    MoveItem CurrentMove;
+
+    const char* Part = MoveString;
+    const char* End = MoveString + strlen(MoveString);
+
+    const char* PieceChars = "NBRQK"; // Promote piece: "NBRQ"
+    const char* PieceChar;
+
+    // Check/checkmate and annotation (not checked)
+
+    while (End > Part && strchr("+#!?", End[-1]) != NULL) {
+        --End;
+    }
+
+    // Castle moves
+
+    if (End - Part == 3 && strncmp(Part, "O-O", 3) == 0) { // O-O
+        From = LSB(Board->BB_Pieces[Color][KING]);
+
+        if (
+            (Board->CastleFlags & (Color == WHITE ? CASTLE_WHITE_KING : CASTLE_BLACK_KING))
+            && Board->Pieces[From + 1] == NO_PIECE && Board->Pieces[From + 2] == NO_PIECE
+            && !IsSquareAttacked(Board, From, Color) && !IsSquareAttacked(Board, From + 1, Color) && !IsSquareAttacked(Board, From + 2, Color)
+        ) {
+            return MOVE_CREATE(From, From + 2, 0);
+        }
+
+        return 0;
+    }
+
+    if (End - Part == 5 && strncmp(Part, "O-O-O", 5) == 0) { // O-O-O
+        From = LSB(Board->BB_Pieces[Color][KING]);
+
+        if (
+            (Board->CastleFlags & (Color == WHITE ? CASTLE_WHITE_QUEEN : CASTLE_BLACK_QUEEN))
+            && Board->Pieces[From - 1] == NO_PIECE && Board->Pieces[From - 2] == NO_PIECE && Board->Pieces[From - 3] == NO_PIECE
+            && !IsSquareAttacked(Board, From, Color) && !IsSquareAttacked(Board, From - 1, Color) && !IsSquareAttacked(Board, From - 2, Color)
+        ) {
+            return MOVE_CREATE(From, From - 2, 0);
+        }
+
+        return 0;
+    }
+
+    // Piece
+
+    if (Part < End && (PieceChar = strchr(PieceChars, *Part)) != NULL) {
+        PieceType = KNIGHT + (int)(PieceChar - PieceChars);
+
+        ++Part;
+    }
+
+    // Promote piece
+
+    if (PieceType == PAWN && End - Part > 2 && (PieceChar = strchr(PieceChars, End[-1])) != NULL && *PieceChar != 'K') {
+        PromotePieceType = KNIGHT + (int)(PieceChar - PieceChars);
+
+        --End;
+
+        if (End[-1] == '=') {
+            --End;
+        }
+    }
+
+    // Square to
+
+    if (End - Part < 2 || End[-2] < 'a' || End[-2] > 'h' || End[-1] < '1' || End[-1] > '8') {
+        return 0;
+    }
+
+    To = SQUARE_CREATE(End[-2] - 'a', '8' - End[-1]);
+
+    End -= 2;
+
+    if (End > Part && End[-1] == 'x') { // Capture
+        --End;
+    }
+
+    // Square from (disambiguation)
+
+    if (Part < End && *Part >= 'a' && *Part <= 'h') {
+        FileFrom = *Part++ - 'a';
+    }
+
+    if (Part < End && *Part >= '1' && *Part <= '8') {
+        RankFrom = '8' - *Part++;
+    }
+
+    if (Part != End) { // Unknown characters
+        return 0;
+    }
+
+    if (Own & BB_SQUARE(To)) {
+        return 0;
+    }
+
+    // Pieces that can move to the square
+
+    switch (PieceType) {
+        case PAWN:
+            if ((RANK(To) == 0 || RANK(To) == 7) != (PromotePieceType != 0)) { // Promote piece only (and always) on the last rank
+                return 0;
+            }
+
+            if ((Occupied & BB_SQUARE(To)) || To == Board->PassantSquare) { // Capture
+                Candidates = PawnAttacks(BB_SQUARE(To), CHANGE_COLOR(Color)) & Board->BB_Pieces[Color][PAWN];
+            }
+            else { // Pushed move
+                From = (Color == WHITE ? To + 8 : To - 8);
+
+                if (From < 0 || From > 63) {
+                    return 0;
+                }
+
+                if (Board->Pieces[From] == NO_PIECE && RANK(To) == (Color == WHITE ? 4 : 3)) { // Pushed move 2
+                    From = (Color == WHITE ? From + 8 : From - 8);
+                }
+
+                Candidates = BB_SQUARE(From) & Board->BB_Pieces[Color][PAWN];
+            }
+
+            break;
+
+        case KNIGHT:
+            Candidates = KnightAttacks(To) & Board->BB_Pieces[Color][KNIGHT];
+            break;
+
+        case BISHOP:
+            Candidates = BishopAttacks(To, Occupied) & Board->BB_Pieces[Color][BISHOP];
+            break;
+
+        case ROOK:
+            Candidates = RookAttacks(To, Occupied) & Board->BB_Pieces[Color][ROOK];
+            break;
+
+        case QUEEN:
+            Candidates = QueenAttacks(To, Occupied) & Board->BB_Pieces[Color][QUEEN];
+            break;
+
+        default: // KING
+            Candidates = KingAttacks(To) & Board->BB_Pieces[Color][KING];
+    }
+
+    if (FileFrom != -1) {
+        Candidates &= BB_FILE_A << FileFrom;
+    }
+
+    if (RankFrom != -1) {
+        Candidates &= BB_RANK_8 << (RankFrom * 8);
+    }
+
+    // The first legal move (the move is not ambiguous in correct notation)
+
+    while (Candidates) {
+        From = LSB(Candidates);
+
+        Move = MOVE_CREATE(From, To, PromotePieceType);
+
+        CurrentMove = CreateMoveItem(Board, Move);
+
+        MakeMove(Board, CurrentMove);
+
+        if (!IsInCheck(Board, CHANGE_COLOR(Board->CurrentColor))) { // Legal move
+            UnmakeMove(Board);
+
+            return Move;
+        }
+
+        UnmakeMove(Board);
+
+        Candidates &= Candidates - 1;
+    }
+
+    return 0;
+}
+
 int PositionRepeat1(const BoardItem* Board)
 {
     if (Board->FiftyMove < 4) {
         return 0;
     }
 
-    for (int Index = Board->HalfMoveNumber - 2; Index >= Board->HalfMoveNumber - Board->FiftyMove; Index -= 2) {
+    if (!Board->RepetitionFilter[Board->Hash & (REPETITION_FILTER_SIZE - 1)]) { // Position not found in the move table
+        return 0;
+    }
+
+    for (int Index = Board->HalfMoveNumber - 2; Index >= 0 && Index >= Board->HalfMoveNumber - Board->FiftyMove; Index -= 2) {
         if (Board->MoveTable[Index].Hash == Board->Hash) {
             return 1;
         }
@@ -334,7 +534,11 @@ int PositionRepeat2(const BoardItem* Board)
         return 0;
     }
 
-    for (int Index = Board->HalfMoveNumber - 2; Index >= Board->HalfMoveNumber - Board->FiftyMove; Index -= 2) {
+    if (!Board->RepetitionFilter[Board->Hash & (REPETITION_FILTER_SIZE - 1)]) { // Position not found in the move table
+        return 0;
+    }
+
+    for (int Index = Board->HalfMoveNumber - 2; Index >= 0 && Index >= Board->HalfMoveNumber - Board->FiftyMove; Index -= 2) {
         if (Board->MoveTable[Index].Hash == Board->Hash) {
             ++RepeatCounter;
         }
@@ -343,6 +547,67 @@ int PositionRepeat2(const BoardItem* Board)
     return RepeatCounter;
 }
 
+#ifdef UPCOMING_REPETITION
+BOOL UpcomingRepetition(const BoardItem* Board, const int Ply) // Stockfish
+{
+    U64 Occupied = Board->BB_WhitePieces | Board->BB_BlackPieces;
+
+    U64 MoveKey;
+
+    int Index;
+    int CuckooIndex;
+
+    int From;
+    int To;
+    int PieceType;
+
+    int MaxDistance = MIN(Board->FiftyMove, Ply - 1); // Only repetitions inside the search tree
+
+    if (MaxDistance < 3) {
+        return FALSE;
+    }
+
+    if (Board->MoveTable[Board->HalfMoveNumber - 1].Type == MOVE_NULL) {
+        return FALSE;
+    }
+
+    for (int Distance = 3; Distance <= MaxDistance; Distance += 2) {
+        Index = Board->HalfMoveNumber - Distance;
+
+        if (Board->MoveTable[Index + 1].Type == MOVE_NULL || Board->MoveTable[Index].Type == MOVE_NULL) {
+            break; // for
+        }
+
+        MoveKey = Board->Hash ^ Board->MoveTable[Index].Hash;
+
+        CuckooIndex = CUCKOO_H1(MoveKey);
+
+        if (CuckooKey[CuckooIndex] != MoveKey) {
+            CuckooIndex = CUCKOO_H2(MoveKey);
+
+            if (CuckooKey[CuckooIndex] != MoveKey) {
+                continue; // Next position
+            }
+        }
+
+        From = MOVE_FROM(CuckooMove[CuckooIndex]);
+        To = MOVE_TO(CuckooMove[CuckooIndex]);
+
+        PieceType = MOVE_PROMOTE_PIECE_TYPE(CuckooMove[CuckooIndex]);
+
+        if (PieceType == KNIGHT || PieceType == KING) {
+            return TRUE;
+        }
+
+        if (QueenAttacks(From, Occupied) & BB_SQUARE(To)) { // The path between the squares is empty
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+#endif // UPCOMING_REPETITION
+
 BOOL IsInsufficientMaterial(const BoardItem* Board)
 {
     if (POPCNT(Board->BB_WhitePieces | Board->BB_BlackPieces) <= 3) { // KK or KxK
@@ -642,7 +907,10 @@ int SetFen(BoardItem* Board, const char* Fen)
 
     InitHash(Board);
 
+    Board->HashStore = &HashStore; // Shared hash table
+
     memset(Board->MoveTable, 0, sizeof(Board->MoveTable));
+    memset(Board->RepetitionFilter, 0, sizeof(Board->RepetitionFilter));
 
     return (int)(Part - Fen);
 }
@@ -748,31 +1016,4 @@ void GetFen(const BoardItem* Board, char* Fen)
     Fen += sprintf_s(Fen, MAX_FEN_LENGTH, "%d", Board->HalfMoveNumber / 2 + 1);
 
     *Fen = '\0'; // Nul
-}
-
-U64 CountLegalMoves(BoardItem* Board, const int Depth)
-{
-    int GenMoveCount;
-    MoveItem MoveList[MAX_GEN_MOVES];
-
-    U64 LegalMoveCount = 0ULL;
-
-    if (Depth == 0) {
-        return 1ULL;
-    }
-
-    GenMoveCount = 0;
-    GenerateAllMoves(Board, NULL, MoveList, &GenMoveCount);
-
-    for (int MoveNumber = 0; MoveNumber < GenMoveCount; ++MoveNumber) {
-        MakeMove(Board, MoveList[MoveNumber]);
-
-        if (!IsInCheck(Board, CHANGE_COLOR(Board->CurrentColor))) { // Legal move
-            LegalMoveCount += CountLegalMoves(Board, Depth - 1);
-        }
-
-        UnmakeMove(Board);
-    }
-
-    return LegalMoveCount;
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #define BOARD_H
 
 #include "Def.h"
+#include "Statistic.h"
 #include "Types.h"
 
 /*
@@ -131,10 +132,47 @@ typedef struct {
     int SortValue;
 } MoveItem; // 12 bytes
 
+typedef struct {
+    U16 Move[MAX_GEN_MOVES];                            // (PromotePieceType << 12) | (From << 6) | To // 512 bytes
+    _declspec(align(32)) int SortValue[MAX_GEN_MOVES];  // 1024 bytes
+} MoveListItem; // 1536 bytes
+
 typedef struct {
     _declspec(align(64)) I16 Accumulator[2][512]; // [Perspective][Hidden dimension]
 } AccumulatorItem; // 2048 bytes
 
+typedef struct {
+    I16 Score;
+    I16 StaticScore;
+
+    U16 Move;
+
+    I8 Depth;
+
+    U8 Flag : 4, Iteration : 4;
+} HashDataS; // 8 bytes
+
+typedef union {
+    U64 RawData;
+
+    HashDataS Data;
+} HashDataU; // 8 bytes
+
+typedef struct {
+    U64 KeyValue;
+
+    HashDataU Value;
+} HashItem; // 16 bytes
+
+typedef struct {
+    U64 Size;
+    U64 Mask;
+
+    U8 Iteration; // 4 bits
+
+    HashItem* Item;
+} HashStoreItem;
+
 typedef struct {
     int Type;
 
@@ -175,19 +213,25 @@ typedef struct {
 
     U64 Hash;
 
+    HashStoreItem* HashStore; // Shared hash table (SetFen) or own hash table of the thread
+
     HistoryItem MoveTable[MAX_GAME_MOVES]; // 49152 bytes
 
+    U16 RepetitionFilter[REPETITION_FILTER_SIZE]; // Positions in the move table by hash // 8192 bytes
+
     U64 Nodes;
 
-#ifdef USE_STATISTIC
-    U64 HashCount;
-    U64 EvaluateCount;
-    U64 CutoffCount;
-    U64 QuiescenceCount;
-#endif // USE_STATISTIC
+    U64 NodeLimit; // Own node limit of the thread (0 = no limit; one search per thread)
+    U64 TimeLimit; // Own time limit of the thread (clock; 0 = no limit; one search per thread)
+    BOOL LimitReached;
+
+    StatisticItem Statistic; // 320 bytes
 
     int SelDepth;
 
+    U64 RootNodes; // Root node: nodes before the moves of the last search (aspiration window re-searches are not counted)
+    U64 BestMoveNodes; // Root node: nodes of the best move (the last search)
+
     MoveItem BestMovesRoot[MAX_PLY]; // 1536 bytes
 
     int HeuristicTable[2][6][64]; // [Color][Piece][Square] // 3072 bytes
@@ -205,7 +249,7 @@ typedef struct {
 #endif // COUNTER_MOVE
 
     AccumulatorItem Accumulator; // 2048 bytes
-} BoardItem; // 650176 bytes
+} BoardItem; // 658368 bytes
 
 extern const char* BoardName[64];
 
@@ -223,7 +267,7 @@ extern BoardItem CurrentBoard;
 extern BoardItem ThreadBoardList[MAX_THREADS];
 
 #ifdef LATE_MOVE_PRUNING
-extern int LateMovePruningTable[7]; // [LMP depth]
+extern const int LateMovePruningTable[7]; // [LMP depth]
 #endif // LATE_MOVE_PRUNING
 
 #ifdef LATE_MOVE_REDUCTION
@@ -236,10 +280,15 @@ BOOL IsInCheck(const BoardItem* Board, const int Color);
 BOOL HasLegalMoves(BoardItem* Board);
 
 void NotateMove(BoardItem* Board, const MoveItem Move, char* Result);
+int ParseMove(BoardItem* Board, const char* MoveString);
 
 int PositionRepeat1(const BoardItem* Board);
 int PositionRepeat2(const BoardItem* Board);
 
+#ifdef UPCOMING_REPETITION
+BOOL UpcomingRepetition(const BoardItem* Board, const int Ply);
+#endif // UPCOMING_REPETITION
+
 BOOL IsInsufficientMaterial(const BoardItem* Board);
 
 void PrintBoard(BoardItem* Board);
@@ -249,6 +298,4 @@ void PrintBitMask(const U64 Mask);
 int SetFen(BoardItem* Board, const char* Fen);
 void GetFen(const BoardItem* Board, char* Fen);
 
-U64 CountLegalMoves(BoardItem* Board, const int Depth);
-
 #endif // !BOARD_H
\ No newline at end of file
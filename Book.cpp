@@ -10,15 +10,11 @@
 #include "Gen.h"
 #include "Hash.h"
 #include "Move.h"
+#include "Pgn.h"
+#include "Polyglot.h"
 #include "Types.h"
 #include "Utils.h"
 
-#define STAGE_NONE      1
-#define STAGE_TAG       2
-#define STAGE_NOTATION  3
-#define STAGE_MOVE      4
-#define STAGE_COMMENT   5
-
 #define MAX_BOOK_PLY    24 // 12 moves
 #define MIN_BOOK_ELO    0
 #define MIN_BOOK_GAMES  30
@@ -27,508 +23,409 @@ BookStoreItem BookStore;
 
 BOOL BookFileLoaded = FALSE;
 
-NodeItem* CreateNode(const MoveItem Move)
-{
-    NodeItem* Node = (NodeItem*)calloc(1, sizeof(NodeItem));
-
-    if (Node == NULL) { // Allocate memory error
-        printf("Allocate memory to node error!\n");
+#define BOOK_TREE_INIT_SIZE 65536 // Entries and buckets
 
-        return NULL;
-    }
+BOOL InitBookTree(BookTreeItem* BookTree)
+{
+    BookTree->Count = 0;
+    BookTree->MaxCount = BOOK_TREE_INIT_SIZE;
 
-    Node->Move = Move;
+    BookTree->BucketCount = BOOK_TREE_INIT_SIZE;
 
-    return Node;
-}
+    BookTree->Entry = (BookEntryItem*)malloc(BookTree->MaxCount * sizeof(BookEntryItem));
+    BookTree->Bucket = (int*)malloc(BookTree->BucketCount * sizeof(int));
 
-void FreeNode(NodeItem* Node)
-{
-    NodeItem* ChildNode;
+    if (BookTree->Entry == NULL || BookTree->Bucket == NULL) { // Allocate memory error
+        printf("Allocate memory to book tree error!\n");
 
-    for (int Index = 0; Index < MAX_CHILDREN; ++Index) {
-        ChildNode = Node->Children[Index];
+        free(BookTree->Entry);
+        free(BookTree->Bucket);
 
-        if (ChildNode) {
-            FreeNode(ChildNode);
-        }
+        return FALSE;
     }
 
-    free(Node);
+    memset(BookTree->Bucket, -1, BookTree->BucketCount * sizeof(int));
+
+    return TRUE;
 }
 
-void PrintNode(BoardItem* Board, const NodeItem* Node, FILE* FileOut)
+void FreeBookTree(BookTreeItem* BookTree)
 {
-    NodeItem* ChildNode;
-
-    int Total = 0;
-
-    for (int Index = 0; Index < MAX_CHILDREN; ++Index) {
-        ChildNode = Node->Children[Index];
-
-        if (ChildNode) {
-            Total += ChildNode->Total;
-        }
-    }
-
-    if (Total < MIN_BOOK_GAMES) {
-        return;
-    }
+    free(BookTree->Entry);
+    free(BookTree->Bucket);
+}
 
-    for (int Index = 0; Index < MAX_CHILDREN; ++Index) {
-        ChildNode = Node->Children[Index];
+BookEntryItem* AddBookEntry(BookTreeItem* BookTree, const U64 Hash, const int Move)
+{
+    BookEntryItem* Entry;
+    BookEntryItem* NewEntry;
 
-        if (ChildNode) {
-//            printf("0x%016llx %s %s %d\n", Board->Hash, BoardName[MOVE_FROM(ChildNode->Move.Move)], BoardName[MOVE_TO(ChildNode->Move.Move)], ChildNode->Total);
+    int* NewBucket;
 
-            fprintf(FileOut, "0x%016llx %d %d %d\n", Board->Hash, MOVE_FROM(ChildNode->Move.Move), MOVE_TO(ChildNode->Move.Move), ChildNode->Total);
+    int Index;
+    int Bucket;
 
-            MakeMove(Board, ChildNode->Move);
+    // Find (position hash, move) in the bucket
 
-            PrintNode(Board, ChildNode, FileOut);
+    for (Index = BookTree->Bucket[Hash & (BookTree->BucketCount - 1)]; Index != -1; Index = Entry->Next) {
+        Entry = &BookTree->Entry[Index];
 
-            UnmakeMove(Board);
+        if (Entry->Hash == Hash && Entry->Move == Move) { // Transpositions are merged
+            return Entry;
         }
     }
-}
-
-void GenerateBook(void)
-{
-    FILE* FileIn;
-    FILE* FileOut;
-
-    int GameNumber;
 
-    int Result;
+    // Allocate new entry from the arena
 
-    int Elo;
-    int MinElo;
+    if (BookTree->Count == BookTree->MaxCount) {
+        NewEntry = (BookEntryItem*)realloc(BookTree->Entry, 2 * BookTree->MaxCount * sizeof(BookEntryItem));
 
-    char MoveString[16];
-    char* Move;
+        if (NewEntry == NULL) { // Allocate memory error
+            printf("Allocate memory to book tree error!\n");
 
-    int Ply;
-
-    NodeItem* RootNode;
-    NodeItem* Node;
-    NodeItem* ChildNode;
+            return NULL;
+        }
 
-    BOOL Error;
+        BookTree->Entry = NewEntry;
+        BookTree->MaxCount *= 2;
+    }
 
-    int Stage;
+    // Double the buckets (load factor <= 1)
 
-    char Buf[4096];
-    char* Part;
+    if (BookTree->Count == BookTree->BucketCount) {
+        NewBucket = (int*)realloc(BookTree->Bucket, 2 * BookTree->BucketCount * sizeof(int));
 
-    char FenString[MAX_FEN_LENGTH];
-    char* Fen;
+        if (NewBucket == NULL) { // Allocate memory error
+            printf("Allocate memory to book tree error!\n");
 
-    int GenMoveCount;
-    MoveItem MoveList[MAX_GEN_MOVES];
+            return NULL;
+        }
 
-    BOOL MoveFound;
+        BookTree->Bucket = NewBucket;
+        BookTree->BucketCount *= 2;
 
-    char NotateMoveStr[16];
+        memset(BookTree->Bucket, -1, BookTree->BucketCount * sizeof(int));
 
-//    printf("NodeItem = %zd\n", sizeof(NodeItem));
+        for (Index = BookTree->Count - 1; Index >= 0; --Index) { // Keep the order of entries in the bucket
+            Entry = &BookTree->Entry[Index];
 
-    printf("\n");
+            Bucket = (int)(Entry->Hash & (BookTree->BucketCount - 1));
 
-    printf("Generate book file from PGN file...\n");
-
-    RootNode = CreateNode((MoveItem){ 0, 0, 0 });
-
-    if (RootNode == NULL) { // Create node error
-        return;
+            Entry->Next = BookTree->Bucket[Bucket];
+            BookTree->Bucket[Bucket] = Index;
+        }
     }
 
-    fopen_s(&FileIn, "book.pgn", "r");
+    Index = BookTree->Count++;
 
-    if (FileIn == NULL) { // File open error
-        printf("File 'book.pgn' open error!\n");
+    Entry = &BookTree->Entry[Index];
 
-        FreeNode(RootNode);
+    Entry->Hash = Hash;
 
-        return;
-    }
+    Entry->Move = (U16)Move;
+    Entry->Stored = FALSE;
 
-    fopen_s(&FileOut, DEFAULT_BOOK_FILE_NAME, "w");
+    Entry->Total = 0;
 
-    if (FileOut == NULL) { // File create (open) error
-        printf("File '%s' create (open) error!\n", DEFAULT_BOOK_FILE_NAME);
+    // Append to the end of the bucket (moves in order of first appearance)
 
-        fclose(FileIn);
+    Entry->Next = -1;
 
-        FreeNode(RootNode);
+    Bucket = (int)(Hash & (BookTree->BucketCount - 1));
 
-        return;
+    if (BookTree->Bucket[Bucket] == -1) {
+        BookTree->Bucket[Bucket] = Index;
     }
+    else {
+        for (NewEntry = &BookTree->Entry[BookTree->Bucket[Bucket]]; NewEntry->Next != -1; NewEntry = &BookTree->Entry[NewEntry->Next]);
 
-    // Cache not used
-
-    InitHashTable(1);
-
-    // Threads not used
-
-    omp_set_num_threads(1);
-
-    // Prepare new game
-
-    GameNumber = 1;
-
-    Result = 0; // Draw default
+        NewEntry->Next = Index;
+    }
 
-    MinElo = INT_MAX;
+    return Entry;
+}
 
-    Move = MoveString;
-    *Move = '\0'; // Nul
+BOOL AddBookItem(BookListItem* BookList, const U64 Hash, const int Move, const int Total)
+{
+    BookItem* NewItem;
 
-    Ply = 0;
+    BookItem* BookItemPointer;
 
-    Node = RootNode;
+    if (BookList->Count == BookList->MaxCount) {
+        BookList->MaxCount = BookList->MaxCount ? BookList->MaxCount * 2 : 4096;
 
-    Error = FALSE;
+        NewItem = (BookItem*)realloc(BookList->Item, BookList->MaxCount * sizeof(BookItem));
 
-    SetFen(&CurrentBoard, StartFen);
+        if (NewItem == NULL) { // Allocate memory error
+            printf("Allocate memory to store book error!\n");
 
-    Stage = STAGE_NONE;
+            return FALSE;
+        }
 
-    while (fgets(Buf, sizeof(Buf), FileIn) != NULL) {
-        Part = Buf;
+        BookList->Item = NewItem;
+    }
 
-        if (*Part == '\r' || *Part == '\n') { // Empty string
-            if (Stage == STAGE_NOTATION) {
-                // Prepare new game
+    BookItemPointer = &BookList->Item[BookList->Count++];
 
-                ++GameNumber;
+    BookItemPointer->Hash = Hash;
 
-                Result = 0; // Draw default
+    BookItemPointer->Move = (U16)Move;
+    BookItemPointer->Reserved = 0;
 
-                MinElo = INT_MAX;
+    BookItemPointer->Total = (U32)Total;
 
-                Move = MoveString;
-                *Move = '\0'; // Nul
+    return TRUE;
+}
 
-                Ply = 0;
+BOOL StoreBookTree(BoardItem* Board, BookTreeItem* BookTree, BookListItem* BookList, BookListItem* PolyglotList)
+{
+    BookEntryItem* Entry;
 
-                Node = RootNode;
+    MoveItem Move;
 
-                Error = FALSE;
+    int Total = 0;
 
-                SetFen(&CurrentBoard, StartFen);
+    for (int Index = BookTree->Bucket[Board->Hash & (BookTree->BucketCount - 1)]; Index != -1; Index = Entry->Next) {
+        Entry = &BookTree->Entry[Index];
 
-                Stage = STAGE_NONE;
+        if (Entry->Hash == Board->Hash) {
+            if (Entry->Stored) { // Position already stored (transposition)
+                return TRUE;
             }
 
-            continue; // Next string
+            Total += Entry->Total;
         }
+    }
 
-        if (*Part == '[') { // Tag
-            if (Stage == STAGE_NONE) {
-                if (GameNumber > 1 && (GameNumber - 1) % 10000 == 0) {
-                    printf("\n");
-
-                    printf("Game number = %d\n", GameNumber - 1);
-
-                    printf("\n");
-
-                    printf("  White = %d Black = %d Draw = %d Total = %d\n", RootNode->White, RootNode->Black, RootNode->Draw, RootNode->Total);
-                    printf("  White = %.1f%% Black = %.1f%% Draw = %.1f%%\n", 100.0 * (double)RootNode->White / (double)RootNode->Total, 100.0 * (double)RootNode->Black / (double)RootNode->Total, 100.0 * (double)RootNode->Draw / (double)RootNode->Total);
-                    printf("  White score = %.1f%%\n", 100.0 * ((double)RootNode->White + (double)RootNode->Draw / 2.0) / (double)RootNode->Total);
-                }
-
-                Stage = STAGE_TAG;
-            }
-
-            if (strncmp(Part, "[Result \"1-0\"]", 14) == 0) { // Result 1-0
-                Result = 1; // White win
-
-//                printf("Result = %d\n", Result);
-            }
-            else if (strncmp(Part, "[Result \"1/2-1/2\"]", 18) == 0) { // Result 1/2-1/2
-                Result = 0; // Draw
-
-//                printf("Result = %d\n", Result);
-            }
-            else if (strncmp(Part, "[Result \"0-1\"]", 14) == 0) { // Result 0-1
-                Result = -1; // Black win
-
-//                printf("Result = %d\n", Result);
-            }
-            else if (strncmp(Part, "[FEN \"", 6) == 0) { // FEN
-                Part += 6;
-
-                Fen = FenString;
-
-                while (*Part != '"') {
-                    *Fen++ = *Part++; // Copy FEN
-                }
-
-                *Fen = '\0'; // Nul
-
-//                printf("FEN = %s\n", FenString);
+    if (Total < MIN_BOOK_GAMES) {
+        return TRUE;
+    }
 
-                SetFen(&CurrentBoard, FenString);
-            }
-            else if (strncmp(Part, "[WhiteElo \"", 11) == 0) { // WhiteElo
-                Part += 11;
+    for (int Index = BookTree->Bucket[Board->Hash & (BookTree->BucketCount - 1)]; Index != -1; Index = Entry->Next) {
+        Entry = &BookTree->Entry[Index];
 
-                Elo = atoi(Part);
+        if (Entry->Hash != Board->Hash) {
+            continue; // Next entry
+        }
 
-                MinElo = MIN(MinElo, Elo);
+        Entry->Stored = TRUE;
 
-//                printf("WhiteElo = %d MinElo = %d\n", Elo, MinElo);
-            }
-            else if (strncmp(Part, "[BlackElo \"", 11) == 0) { // BlackElo
-                Part += 11;
+        Move = CreateMoveItem(Board, Entry->Move);
 
-                Elo = atoi(Part);
+//        printf("0x%016llx %s %s %d\n", Board->Hash, BoardName[MOVE_FROM(Move.Move)], BoardName[MOVE_TO(Move.Move)], Entry->Total);
 
-                MinElo = MIN(MinElo, Elo);
+        if (!AddBookItem(BookList, Board->Hash, Move.Move, Entry->Total)) {
+            return FALSE;
+        }
 
-//                printf("BlackElo = %d MinElo = %d\n", Elo, MinElo);
-            }
+        if (PolyglotList && !AddBookItem(PolyglotList, PolyglotKey(Board), PolyglotMove(Move), Entry->Total)) {
+            return FALSE;
+        }
 
-            continue; // Next string
-        } // if
+        MakeMove(Board, Move);
 
-        if (Stage == STAGE_TAG) {
-            if (MinElo >= MIN_BOOK_ELO) {
-                if (Result == 1) { // White win
-                    ++RootNode->White;
+        if (!StoreBookTree(Board, BookTree, BookList, PolyglotList)) {
+            UnmakeMove(Board);
 
-                    ++RootNode->Total;
-                }
-                else if (Result == 0) { // Draw
-                    ++RootNode->Draw;
+            return FALSE;
+        }
 
-                    ++RootNode->Total;
-                }
-                else if (Result == -1) { // Black win
-                    ++RootNode->Black;
+        UnmakeMove(Board);
+    }
 
-                    ++RootNode->Total;
-                }
-            }
+    return TRUE;
+}
 
-            Stage = STAGE_NOTATION;
-        }
+int HashCompare(const void* BookItem1, const void* BookItem2)
+{
+    U64 Hash1 = ((BookItem*)BookItem1)->Hash;
+    U64 Hash2 = ((BookItem*)BookItem2)->Hash;
 
-        if (Error || Ply >= MAX_BOOK_PLY || MinElo < MIN_BOOK_ELO) {
-            continue; // Next string
-        }
+    if (Hash1 < Hash2) {
+        return -1;
+    }
 
-        while (*Part != '\0') { // Scan string
-            if (*Part == '{') { // Comment (open)
-                Stage = STAGE_COMMENT;
-            }
-            else if (*Part == '}') { // Comment (close)
-                Stage = STAGE_NOTATION;
-            }
+    if (Hash1 > Hash2) {
+        return 1;
+    }
 
-            if (Stage == STAGE_NOTATION) {
-                if (strchr(MoveFirstChar, *Part) != NULL) {
-                    Stage = STAGE_MOVE;
+    return ((BookItem*)BookItem1)->Move - ((BookItem*)BookItem2)->Move; // Stable order of moves
+}
 
-                    Move = MoveString;
+void GenerateBook(void)
+{
+    FILE* FileOut;
 
-                    *Move++ = *Part; // Copy move (first char)
-                }
-            }
-            else if (Stage == STAGE_MOVE) {
-                if (strchr(MoveSubsequentChar, *Part) != NULL) {
-                    *Move++ = *Part; // Copy move (subsequent char)
-                }
-                else { // End of move
-                    *Move = '\0'; // Nul
+    PgnReaderItem Reader;
+    PgnGameItem* Game;
 
-                    Stage = STAGE_NOTATION;
+    int GameNumber;
 
-                    if (Error || Ply >= MAX_BOOK_PLY || MinElo < MIN_BOOK_ELO) {
-                        ++Part;
+    BookTreeItem BookTree;
+    BookEntryItem* Entry;
 
-                        continue; // Next character in string
-                    }
+    BookStatItem RootStat = { 0, 0, 0, 0 };
 
-//                    printf("Ply = %d Result = %d Move = %s\n", Ply, Result, MoveString);
+    BOOL Error;
 
-                    GenMoveCount = 0;
-                    GenerateAllMoves(&CurrentBoard, NULL, MoveList, &GenMoveCount);
+    BookListItem BookList = { 0, 0, NULL };
+    BookListItem PolyglotList = { 0, 0, NULL };
 
-                    MoveFound = FALSE;
+    int SavedThreads;
 
-                    for (int MoveNumber = 0; MoveNumber < GenMoveCount; ++MoveNumber) {
-                        NotateMove(&CurrentBoard, MoveList[MoveNumber], NotateMoveStr);
+//    printf("BookEntryItem = %zd\n", sizeof(BookEntryItem));
 
-                        if (strcmp(MoveString, NotateMoveStr) == 0) {
-                            MakeMove(&CurrentBoard, MoveList[MoveNumber]);
+    printf("\n");
 
-                            if (IsInCheck(&CurrentBoard, CHANGE_COLOR(CurrentBoard.CurrentColor))) { // Illegal move
-                                UnmakeMove(&CurrentBoard);
+    printf("Generate book file from PGN file...\n");
 
-                                PrintBoard(&CurrentBoard);
+    if (!InitBookTree(&BookTree)) {
+        return;
+    }
 
-                                printf("\n");
+    if (!OpenPgnReader(&Reader, "book.pgn", MAX_BOOK_PLY, MIN_BOOK_ELO)) {
+        FreeBookTree(&BookTree);
 
-                                printf("Illegal move (%s)!\n", MoveString);
+        return;
+    }
 
-                                continue; // Next move
-                            }
+    fopen_s(&FileOut, DEFAULT_BOOK_FILE_NAME, "wb");
 
-                            MoveFound = TRUE;
+    if (FileOut == NULL) { // File create (open) error
+        printf("File '%s' create (open) error!\n", DEFAULT_BOOK_FILE_NAME);
 
-                            ChildNode = NULL;
+        ClosePgnReader(&Reader);
 
-                            for (int Index = 0; Index < MAX_CHILDREN; ++Index) {
-                                if (Node->Children[Index]) {
-                                    if (Node->Children[Index]->Move.Move == MoveList[MoveNumber].Move) {
-                                        ChildNode = Node->Children[Index];
+        FreeBookTree(&BookTree);
 
-                                        break; // for (children)
-                                    }
-                                }
-                                else {
-                                    ChildNode = CreateNode(MoveList[MoveNumber]);
+        return;
+    }
 
-                                    if (ChildNode == NULL) { // Create node error
-                                        break; // for (children)
-                                    }
+    // Cache not used
 
-                                    Node->Children[Index] = ChildNode;
+    InitHashTable(1);
 
-                                    break; // for (children)
-                                }
-                            }
+    // Threads are used to parse games (the book tree is updated in game order)
 
-                            if (ChildNode == NULL) {
-                                Error = TRUE;
+    SavedThreads = omp_get_max_threads(); // Restored at the end
 
-                                printf("\n");
+    omp_set_num_threads(MaxThreads);
 
-                                printf("No child node!\n");
-                            }
-                            else {
-                                if (Result == 1) { // White win
-                                    ++ChildNode->White;
+    GameNumber = 0;
 
-                                    ++ChildNode->Total;
-                                }
-                                else if (Result == 0) { // Draw
-                                    ++ChildNode->Draw;
+    Error = FALSE;
 
-                                    ++ChildNode->Total;
-                                }
-                                else if (Result == -1) { // Black win
-                                    ++ChildNode->Black;
+    while (!Error && ReadPgnGames(&Reader)) {
+        for (int GameIndex = 0; GameIndex < Reader.GameCount; ++GameIndex) {
+            Game = &Reader.Game[GameIndex];
 
-                                    ++ChildNode->Total;
-                                }
+            ++GameNumber;
 
-                                Node = ChildNode;
-                            }
+            if (Game->MinElo >= MIN_BOOK_ELO) {
+                if (Game->Result == 1) { // White win
+                    ++RootStat.White;
 
-                            break; // for (moves)
-                        } // if
-                    } // for
+                    ++RootStat.Total;
+                }
+                else if (Game->Result == 0) { // Draw
+                    ++RootStat.Draw;
 
-                    if (!MoveFound) { // Move not found
-                        Error = TRUE;
+                    ++RootStat.Total;
+                }
+                else if (Game->Result == -1) { // Black win
+                    ++RootStat.Black;
 
-                        PrintBoard(&CurrentBoard);
+                    ++RootStat.Total;
+                }
+            }
 
-                        printf("\n");
+            SetFen(&CurrentBoard, Game->Fen);
 
-                        printf("Move (%s) not found!\n", MoveString);
+            for (int Ply = 0; Ply < Game->MoveCount; ++Ply) {
+                Entry = AddBookEntry(&BookTree, CurrentBoard.Hash, Game->Move[Ply]); // Position hash (before move)
 
-                        printf("\n");
+                if (Entry == NULL) {
+                    Error = TRUE;
 
-                        printf("Gen. moves:");
+                    break; // for (moves)
+                }
 
-                        for (int MoveNumber = 0; MoveNumber < GenMoveCount; ++MoveNumber) {
-                            NotateMove(&CurrentBoard, MoveList[MoveNumber], NotateMoveStr);
+                ++Entry->Total;
 
-                            printf(" %s%s", BoardName[MOVE_FROM(MoveList[MoveNumber].Move)], BoardName[MOVE_TO(MoveList[MoveNumber].Move)]);
+                MakeMove(&CurrentBoard, CreateMoveItem(&CurrentBoard, Game->Move[Ply]));
+            }
 
-                            if (MoveList[MoveNumber].Type & MOVE_PAWN_PROMOTE) {
-                                printf("%c", PiecesCharBlack[MOVE_PROMOTE_PIECE_TYPE(MoveList[MoveNumber].Move)]);
-                            }
+            if (GameNumber % 10000 == 0) {
+                printf("\n");
 
-                            printf(" (%s)", NotateMoveStr);
-                        }
+                printf("Game number = %d\n", GameNumber);
 
-                        printf("\n");
-                    }
+                printf("\n");
 
-                    ++Ply;
-                }
+                printf("  White = %d Black = %d Draw = %d Total = %d\n", RootStat.White, RootStat.Black, RootStat.Draw, RootStat.Total);
+                printf("  White = %.1f%% Black = %.1f%% Draw = %.1f%%\n", 100.0 * (double)RootStat.White / (double)RootStat.Total, 100.0 * (double)RootStat.Black / (double)RootStat.Total, 100.0 * (double)RootStat.Draw / (double)RootStat.Total);
+                printf("  White score = %.1f%%\n", 100.0 * ((double)RootStat.White + (double)RootStat.Draw / 2.0) / (double)RootStat.Total);
             }
-
-            ++Part;
-        } // while
+        } // for (games)
     } // while
 
     printf("\n");
 
-    printf("Game number = %d\n", GameNumber - 1);
+    printf("Game number = %d\n", GameNumber);
 
     printf("\n");
 
-    printf("  White = %d Black = %d Draw = %d Total = %d\n", RootNode->White, RootNode->Black, RootNode->Draw, RootNode->Total);
-    printf("  White = %.1f%% Black = %.1f%% Draw = %.1f%%\n", 100.0 * (double)RootNode->White / (double)RootNode->Total, 100.0 * (double)RootNode->Black / (double)RootNode->Total, 100.0 * (double)RootNode->Draw / (double)RootNode->Total);
-    printf("  White score = %.1f%%\n", 100.0 * ((double)RootNode->White + (double)RootNode->Draw / 2.0) / (double)RootNode->Total);
+    printf("  White = %d Black = %d Draw = %d Total = %d\n", RootStat.White, RootStat.Black, RootStat.Draw, RootStat.Total);
+    printf("  White = %.1f%% Black = %.1f%% Draw = %.1f%%\n", 100.0 * (double)RootStat.White / (double)RootStat.Total, 100.0 * (double)RootStat.Black / (double)RootStat.Total, 100.0 * (double)RootStat.Draw / (double)RootStat.Total);
+    printf("  White score = %.1f%%\n", 100.0 * ((double)RootStat.White + (double)RootStat.Draw / 2.0) / (double)RootStat.Total);
 
     // Prepare new game
 
     SetFen(&CurrentBoard, StartFen);
 
-    PrintNode(&CurrentBoard, RootNode, FileOut);
+    printf("\n");
 
-    fclose(FileOut);
-    fclose(FileIn);
+    if (StoreBookTree(&CurrentBoard, &BookTree, &BookList, &PolyglotList)) {
+        qsort(BookList.Item, BookList.Count, sizeof(BookItem), HashCompare);
 
-    FreeNode(RootNode);
+        if (fwrite(BookList.Item, sizeof(BookItem), BookList.Count, FileOut) != (size_t)BookList.Count) {
+            printf("\n");
 
-    printf("\n");
+            printf("File '%s' write error!\n", DEFAULT_BOOK_FILE_NAME);
+        }
 
-    printf("Generate book file from PGN file...DONE\n");
-}
+        printf("\n");
 
-int HashCompare(const void* BookItem1, const void* BookItem2)
-{
-    U64 Hash1 = ((BookItem*)BookItem1)->Hash;
-    U64 Hash2 = ((BookItem*)BookItem2)->Hash;
+        printf("Book items = %d\n", BookList.Count);
 
-    if (Hash1 < Hash2) {
-        return -1;
+        if (SavePolyglotBook(DEFAULT_POLYGLOT_BOOK_FILE_NAME, &PolyglotList)) {
+            printf("Polyglot book items = %d (%s)\n", PolyglotList.Count, DEFAULT_POLYGLOT_BOOK_FILE_NAME);
+        }
     }
 
-    if (Hash1 > Hash2) {
-        return 1;
-    }
+    free(BookList.Item);
+    free(PolyglotList.Item);
 
-    return 0;
-}
+    fclose(FileOut);
 
-void LoadBook(const char* BookFileName)
-{
-    FILE* File;
+    ClosePgnReader(&Reader);
 
-    char Buf[256];
-    char* Part;
+    omp_set_num_threads(SavedThreads);
 
-    int PositionNumber;
+    printf("\n");
 
-    char HashString[64];
-    char* HashPointer;
+    printf("Book tree entries = %d (%zd Kb)\n", BookTree.Count, (BookTree.MaxCount * sizeof(BookEntryItem) + BookTree.BucketCount * sizeof(int)) / 1024);
 
-    U64 Hash;
+    FreeBookTree(&BookTree);
 
-    int From;
-    int To;
+    printf("\n");
 
-    int Total;
+    printf("Generate book file from PGN file...DONE\n");
+}
 
-    BookItem* BookItemPointer;
+void LoadBook(const char* BookFileName)
+{
+    LARGE_INTEGER FileSize;
 
     printf("\n");
 
@@ -536,125 +433,51 @@ void LoadBook(const char* BookFileName)
 
     FreeBook(); // The book may have been loaded earlier
 
-    fopen_s(&File, BookFileName, "r");
+    BookStore.FileHandle = CreateFileA(BookFileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
 
-    if (File == NULL) { // File open error
+    if (BookStore.FileHandle == INVALID_HANDLE_VALUE) { // File open error
         printf("File '%s' open error!\n", BookFileName);
 
         return;
     }
 
-    // The first cycle to get the number of book items
+    if (!GetFileSizeEx(BookStore.FileHandle, &FileSize) || FileSize.QuadPart == 0 || FileSize.QuadPart % sizeof(BookItem) != 0) { // File size error
+        printf("Read book error!\n");
 
-    BookStore.Count = 0;
+        CloseHandle(BookStore.FileHandle);
 
-    while (fgets(Buf, sizeof(Buf), File) != NULL) {
-        ++BookStore.Count;
+        return;
     }
 
-    // Allocate memory to store book
+    // Map the book file into memory (the pages are shared between engine processes)
 
-    BookStore.Item = (BookItem*)calloc(BookStore.Count, sizeof(BookItem));
+    BookStore.MappingHandle = CreateFileMappingA(BookStore.FileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
 
-    if (BookStore.Item == NULL) { // Allocate memory error
-        printf("Allocate memory to store book error!\n");
+    if (BookStore.MappingHandle == NULL) { // File mapping error
+        printf("Map book error!\n");
 
-        fclose(File);
+        CloseHandle(BookStore.FileHandle);
 
         return;
     }
 
-    // Set the pointer to the beginning of the file
-
-    fseek(File, 0, SEEK_SET);
-
-    // The second cycle to read book items
-
-    PositionNumber = 0;
-
-    while (fgets(Buf, sizeof(Buf), File) != NULL) {
-        Part = Buf;
-
-        HashPointer = HashString;
-
-        while (*Part != ' ') {
-            *HashPointer++ = *Part++; // Copy hash
-        }
-
-        *HashPointer = '\0'; // Nul
-
-        Hash = strtoull(HashString, NULL, 16);
-
-        if (Hash == 0) { // Hash error
-            printf("Read book error!\n");
-
-            free(BookStore.Item);
-
-            fclose(File);
-
-            return;
-        }
-
-        ++Part; // Space
-
-        From = atoi(Part);
-
-        if (From < 0 || From > 63) {
-            printf("Read book error!\n");
-
-            free(BookStore.Item);
-
-            fclose(File);
-
-            return;
-        }
-
-        while (*Part != ' ') {
-            ++Part;
-        }
-
-        ++Part; // Space
-
-        To = atoi(Part);
-
-        if (To < 0 || To > 63) {
-            printf("Read book error!\n");
+    BookStore.Item = (const BookItem*)MapViewOfFile(BookStore.MappingHandle, FILE_MAP_READ, 0, 0, 0);
 
-            free(BookStore.Item);
+    if (BookStore.Item == NULL) { // File mapping error
+        printf("Map book error!\n");
 
-            fclose(File);
+        CloseHandle(BookStore.MappingHandle);
+        CloseHandle(BookStore.FileHandle);
 
-            return;
-        }
-
-        while (*Part != ' ') {
-            ++Part;
-        }
-
-        ++Part; // Space
-
-        Total = atoi(Part);
-
-        BookItemPointer = &BookStore.Item[PositionNumber++];
-
-        BookItemPointer->Hash = Hash;
-
-        BookItemPointer->From = From;
-        BookItemPointer->To = To;
-
-        BookItemPointer->Total = Total;
-    } // while
+        return;
+    }
 
-    qsort(BookStore.Item, BookStore.Count, sizeof(BookItem), HashCompare); // TODO: move to GenerateBook
+    BookStore.Count = (int)(FileSize.QuadPart / sizeof(BookItem));
 /*
     for (int Index = 0; Index < BookStore.Count; ++Index) {
-        BookItemPointer = &BookStore.Item[Index];
-
-        printf("0x%016llx %s %s %d\n", BookItemPointer->Hash, BoardName[BookItemPointer->From], BoardName[BookItemPointer->To], BookItemPointer->Total);
+        printf("0x%016llx %s %s %u\n", BookStore.Item[Index].Hash, BoardName[MOVE_FROM(BookStore.Item[Index].Move)], BoardName[MOVE_TO(BookStore.Item[Index].Move)], BookStore.Item[Index].Total);
     }
 */
-    fclose(File);
-
     BookFileLoaded = TRUE;
 
     printf("Load book...DONE (%d)\n", BookStore.Count);
@@ -663,83 +486,89 @@ void LoadBook(const char* BookFileName)
 void FreeBook(void)
 {
     if (BookFileLoaded) {
-        free(BookStore.Item);
+        UnmapViewOfFile(BookStore.Item);
+
+        CloseHandle(BookStore.MappingHandle);
+        CloseHandle(BookStore.FileHandle);
 
         BookFileLoaded = FALSE;
     }
 }
 
-BOOL GetBookMove(const BoardItem* Board, MoveItem* BestMoves)
+BOOL GetBookMove(const BoardItem* Board, const U64 RandomValue, MoveItem* BestMoves)
 {
     int FirstIndex;
-    int BookCount;
+    int LastIndex;
+
+    int Low;
+    int High;
+    int Middle;
 
     int Total;
     int Selected;
     int Offset;
 
-    BookItem* BookItemPointer;
+    const BookItem* BookItemPointer;
 
     int GenMoveCount;
-    MoveItem MoveList[MAX_GEN_MOVES];
-
-    U64 RandomValue;
+    MoveListItem MoveList;
 
     if (!BookFileLoaded) {
         return FALSE;
     }
 
-    FirstIndex = -1;
-    BookCount = 0;
+    // Binary search of the first book item with position hash
 
-    Total = 0;
+    Low = 0;
+    High = BookStore.Count;
 
-    for (int Index = 0; Index < BookStore.Count; ++Index) {
-        BookItemPointer = &BookStore.Item[Index];
+    while (Low < High) {
+        Middle = Low + (High - Low) / 2;
 
-        if (BookItemPointer->Hash == Board->Hash) { // Position hash found in book
-            if (FirstIndex < 0) {
-                FirstIndex = Index;
-            }
+        if (BookStore.Item[Middle].Hash < Board->Hash) {
+            Low = Middle + 1;
+        }
+        else {
+            High = Middle;
+        }
+    }
 
-            ++BookCount;
+    FirstIndex = Low;
 
-            Total += BookItemPointer->Total;
-        }
+    Total = 0;
+
+    for (LastIndex = FirstIndex; LastIndex < BookStore.Count && BookStore.Item[LastIndex].Hash == Board->Hash; ++LastIndex) {
+        Total += BookStore.Item[LastIndex].Total;
     }
 
-//    printf("BookCount = %d\n", BookCount);
+//    printf("BookCount = %d\n", LastIndex - FirstIndex);
 
-    if (BookCount == 0) { // No moves in book
+    if (Total == 0) { // No moves in book
         return FALSE;
     }
 
     // Weighted random choice
 
-    RandomValue = Rand64();
     Selected = (int)(RandomValue & 0x7FFFFFFF) % Total;
 
 //    printf("Total = %d Selected = %d\n", Total, Selected);
 
     Offset = 0;
 
-    for (int Index = FirstIndex, Count = 0; Count < BookCount; ++Index, ++Count) {
+    for (int Index = FirstIndex; Index < LastIndex; ++Index) {
         BookItemPointer = &BookStore.Item[Index];
 
         Offset += BookItemPointer->Total;
 
         if (Selected < Offset) {
             GenMoveCount = 0;
-            GenerateAllMoves(Board, NULL, MoveList, &GenMoveCount);
+            GenerateAllMoves(Board, NULL, &MoveList, &GenMoveCount);
 
             for (int MoveNumber = 0; MoveNumber < GenMoveCount; ++MoveNumber) {
-                if (
-                    MOVE_FROM(MoveList[MoveNumber].Move) == BookItemPointer->From
-                    && MOVE_TO(MoveList[MoveNumber].Move) == BookItemPointer->To
-                ) { // Valid book move
-//                    printf("0x%016llx %s %s %d\n", BookItemPointer->Hash, BoardName[BookItemPointer->From], BoardName[BookItemPointer->To], BookItemPointer->Total);
+                if (MoveList.Move[MoveNumber] == BookItemPointer->Move) { // Valid book move
+//                    printf("0x%016llx %s %s %u\n", BookItemPointer->Hash, BoardName[MOVE_FROM(BookItemPointer->Move)], BoardName[MOVE_TO(BookItemPointer->Move)], BookItemPointer->Total);
 
-                    BestMoves[0] = MoveList[MoveNumber]; // Best move
+                    BestMoves[0] = CreateMoveItem(Board, MoveList.Move[MoveNumber]); // Best move
                     BestMoves[1] = (MoveItem){ 0, 0, 0 }; // End of move list
 
                     return TRUE;
@@ -9,33 +9,58 @@
 #include "Def.h"
 #include "Types.h"
 
-#define MAX_CHILDREN 32
+typedef struct {
+    U64 Hash; // Position hash (before move)
+
+    U16 Move;
+    U16 Stored;
+
+    int Total;
+
+    int Next; // Next entry in the bucket (-1 = end of bucket)
+} BookEntryItem; // 24 bytes
+
+typedef struct {
+    int Count;
+    int MaxCount;
+
+    BookEntryItem* Entry; // Arena (entries are referenced by index)
 
-typedef struct Node {
-    MoveItem Move;
+    int BucketCount;
+    int* Bucket; // [Hash & (BucketCount - 1)] -> first entry of the position (-1 = empty)
+} BookTreeItem;
 
+typedef struct {
     int White;
     int Draw;
     int Black;
 
     int Total;
-
-    struct Node* Children[MAX_CHILDREN];
-} NodeItem; // 288 bytes
+} BookStatItem;
 
 typedef struct {
     U64 Hash;
 
-    int From;
-    int To;
+    U16 Move;
+    U16 Reserved;
 
-    int Total;
-} BookItem; // 24 bytes
+    U32 Total;
+} BookItem; // 16 bytes (book file entry, sorted by hash)
 
 typedef struct {
     int Count;
+    int MaxCount;
 
     BookItem* Item;
+} BookListItem;
+
+typedef struct {
+    int Count;
+
+    const BookItem* Item;
+
+    HANDLE FileHandle;
+    HANDLE MappingHandle;
 } BookStoreItem;
 
 void GenerateBook(void);
@@ -43,6 +68,6 @@ void GenerateBook(void);
 void LoadBook(const char* BookFileName);
 void FreeBook(void);
 
-BOOL GetBookMove(const BoardItem* Board, MoveItem* BestMoves);
+BOOL GetBookMove(const BoardItem* Board, const U64 RandomValue, MoveItem* BestMoves);
 
 #endif // !BOOK_H
\ No newline at end of file
@@ -10,17 +10,36 @@
 #include "Gen.h"
 #include "Hash.h"
 #include "NNUE2.h"
+#include "Polyglot.h"
 #include "Tests.h"
+#include "Trace.h"
 #include "Tuning.h"
 #include "UCI.h"
 #include "Utils.h"
 
+BOOL LoadDefaultNetwork(void) // Command line
+{
+    LoadNetwork(DEFAULT_NNUE_FILE_NAME);
+
+    if (!IsNetworkLoaded()) {
+        printf("Network not loaded!\n");
+
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
 int main(int argc, char** argv)
 {
     char Buf[64];
 
     int Choice;
 
+    int BenchDepth;
+    int BenchThreads;
+    int BenchHashSize;
+
     // Print program name, program version and copyright information
 
     printf("%s %s\n", PROGRAM_NAME, PROGRAM_VERSION);
@@ -29,6 +48,7 @@ int main(int argc, char** argv)
     // Print debug information
 
 //    printf("MoveItem = %zd\n", sizeof(MoveItem));
+//    printf("MoveListItem = %zd\n", sizeof(MoveListItem));
 //    printf("AccumulatorItem = %zd\n", sizeof(AccumulatorItem));
 //    printf("HistoryItem = %zd\n", sizeof(HistoryItem));
 //    printf("BoardItem = %zd\n", sizeof(BoardItem));
@@ -43,7 +63,7 @@ int main(int argc, char** argv)
 //    printf("BoardItem.CounterMoveTable = %zd\n", sizeof(Board.CounterMoveTable));
 //    printf("BoardItem.Accumulator = %zd\n", sizeof(Board.Accumulator));
 
-//    printf("NodeItem = %zd\n", sizeof(NodeItem));
+//    printf("BookEntryItem = %zd\n", sizeof(BookEntryItem));
 //    printf("BookItem = %zd\n", sizeof(BookItem));
 
 //    printf("HashDataS = %zd\n", sizeof(HashDataS));
@@ -89,16 +109,6 @@ int main(int argc, char** argv)
     SetRandState(0ULL); // For reproducibility
     InitHashBoards();
 
-    // Initialize LMP
-
-#ifdef LATE_MOVE_PRUNING
-    for (int Depth = 0; Depth < 7; ++Depth) {
-        LateMovePruningTable[Depth] = (int)round(2.98484 + pow(Depth, 1.74716)); // Hakkapeliitta
-
-//        printf("LateMovePruningTable[%d] = %d\n", Depth, LateMovePruningTable[Depth]); // 3, 4, 6, 10, 14, 20, 26
-    }
-#endif // LATE_MOVE_PRUNING
-
     // Initialize LMR
 
 #ifdef LATE_MOVE_REDUCTION
@@ -119,6 +129,90 @@ int main(int argc, char** argv)
 
     SetRandState(Clock());
 
+    // Command line: bench [depth] [threads] [hash table size (Mb)] (default network file, book not used)
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        if (!LoadDefaultNetwork()) {
+            goto Done;
+        }
+
+        BenchDepth = (argc > 2) ? atoi(argv[2]) : BENCH_DEFAULT_DEPTH;
+        BenchThreads = (argc > 3) ? atoi(argv[3]) : BENCH_DEFAULT_THREADS;
+        BenchHashSize = (argc > 4) ? atoi(argv[4]) : BENCH_DEFAULT_HASH_TABLE_SIZE;
+
+        BenchDepth = (BenchDepth >= 1 && BenchDepth <= MAX_PLY) ? BenchDepth : BENCH_DEFAULT_DEPTH;
+        BenchThreads = (BenchThreads >= 1 && BenchThreads <= MaxThreads) ? BenchThreads : BENCH_DEFAULT_THREADS;
+        BenchHashSize = (BenchHashSize >= 1 && BenchHashSize <= MAX_HASH_TABLE_SIZE) ? BenchHashSize : BENCH_DEFAULT_HASH_TABLE_SIZE;
+
+        Bench(BenchDepth, BenchThreads, BenchHashSize);
+
+        goto Done;
+    }
+
+    // Command line: kernels [baseline file] [save] (default network file)
+
+    if (argc > 1 && strcmp(argv[1], "kernels") == 0) {
+        if (!LoadDefaultNetwork()) {
+            goto Done;
+        }
+
+        KernelBenchmark((argc > 2) ? argv[2] : KERNEL_BASELINE_FILE_NAME, (argc > 3 && strcmp(argv[3], "save") == 0));
+
+        goto Done;
+    }
+
+    // Command line: scaling [depth] [hash table size (Mb)] [output file] (default network file, book not used)
+
+    if (argc > 1 && strcmp(argv[1], "scaling") == 0) {
+        if (!LoadDefaultNetwork()) {
+            goto Done;
+        }
+
+        BenchDepth = (argc > 2) ? atoi(argv[2]) : SCALING_DEFAULT_DEPTH;
+        BenchHashSize = (argc > 3) ? atoi(argv[3]) : SCALING_DEFAULT_HASH_TABLE_SIZE;
+
+        BenchDepth = (BenchDepth >= 1 && BenchDepth <= MAX_PLY) ? BenchDepth : SCALING_DEFAULT_DEPTH;
+        BenchHashSize = (BenchHashSize >= 1 && BenchHashSize <= MAX_HASH_TABLE_SIZE) ? BenchHashSize : SCALING_DEFAULT_HASH_TABLE_SIZE;
+
+        ScalingTest(BenchDepth, BenchHashSize, (argc > 4) ? argv[4] : SCALING_FILE_NAME);
+
+        goto Done;
+    }
+
+    // Command line: trace <trace file> (summary of the trace saved by UCI option TraceRate)
+
+    if (argc > 2 && strcmp(argv[1], "trace") == 0) {
+        PrintTrace(argv[2]);
+
+        goto Done;
+    }
+
+    // Command line (default network file, book not used):
+    //     evaluate <input file (FEN/EPD)> <output file> [search depth (0 = quiescence search)]
+    //     epd <input file (EPD)> <output file (JSON)> [nodes per position] [time per position (ms)]
+
+    if (argc > 1 && (strcmp(argv[1], "evaluate") == 0 || strcmp(argv[1], "epd") == 0)) {
+        if (argc < 4) {
+            printf("\n");
+
+            printf("Usage: %s evaluate <input file> <output file> [search depth]\n", argv[0]);
+            printf("       %s epd <input file> <output file> [nodes] [time (ms)]\n", argv[0]);
+        }
+        else if (!IsHashTableInitialized()) {
+            printf("Hash table not initialized!\n");
+        }
+        else if (LoadDefaultNetwork()) {
+            if (strcmp(argv[1], "evaluate") == 0) {
+                EvaluateFile(argv[2], argv[3], (argc > 4) ? MIN(atoi(argv[4]), MAX_PLY) : -1);
+            }
+            else { // epd
+                EpdTest(argv[2], argv[3], (argc > 4) ? strtoull(argv[4], NULL, 10) : EPD_DEFAULT_NODES, (argc > 5) ? strtoull(argv[5], NULL, 10) : 0ULL);
+            }
+        }
+
+        goto Done;
+    }
+
     // Load network
 
     if (argc > 1) {
@@ -195,11 +289,14 @@ int main(int argc, char** argv)
         printf("11: Built-in search performance test\n");
         printf("12: Built-in evaluate performance test\n");
 
-        printf("13: Generate book file (book.txt) from PGN file (book.pgn)\n");
+        printf("13: Generate book file (book.bin) from PGN file (book.pgn)\n");
 
         printf("14: Convert PGN file (games.pgn) to FEN file (games.fen)\n");
+        printf("15: Convert PGN file (games.pgn) to packed file (games.bin)\n");
+
+        printf("16: Generate self-play data (selfplay.bin)\n");
 
-        printf("15: Exit\n");
+        printf("17: Exit\n");
 
         printf("\n");
 
@@ -270,7 +367,15 @@ int main(int argc, char** argv)
                 Pgn2Fen();
                 break;
 
-            case 15: // Exit
+            case 15:
+                Pgn2Packed();
+                break;
+
+            case 16:
+                GenerateData();
+                break;
+
+            case 17: // Exit
                 goto Done;
         } // switch
 
@@ -280,8 +385,11 @@ int main(int argc, char** argv)
 Done:
 
     FreeBook();
+    FreePolyglotBook();
 
     FreeHashTable();
 
+    FreeTrace();
+
     return 0;
 }
\ No newline at end of file
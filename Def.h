@@ -25,16 +25,17 @@
 
 #define HASH_PREFETCH
 
+#define USE_SORT_AVX2                           // Move scoring and selection
+
 //#define BIND_THREAD_V1
 //#define BIND_THREAD_V2                        // Max. 64 CPUs
 
-//#define USE_STATISTIC
-
 //#define PRINT_CURRENT_MOVE                    // For UCI in root node
 
 // Search
 
 #define MATE_DISTANCE_PRUNING
+#define UPCOMING_REPETITION                     // Cuckoo tables
 #define REVERSE_FUTILITY_PRUNING
 #define RAZORING
 #define NULL_MOVE_PRUNING
@@ -51,6 +52,7 @@
 #define SEE_QUIET_MOVE_PRUNING
 #define SEE_CAPTURE_MOVE_PRUNING
 #define LATE_MOVE_REDUCTION
+#define QUIET_MOVE_PARTIAL_SORT
 
 // Quiescence search
 
@@ -87,6 +89,8 @@
 
 #define MAX_FEN_LENGTH                          256
 
+#define REPETITION_FILTER_SIZE                  4096    // Must be a power of 2
+
 #define ASPIRATION_WINDOW_START_DEPTH           4
 #define ASPIRATION_WINDOW_INIT_DELTA            17
 
@@ -96,7 +100,8 @@
 #define DEFAULT_THREADS                         1
 #define MAX_THREADS                             64
 
-#define DEFAULT_BOOK_FILE_NAME                  "book.txt"              // 25.10.2024
+#define DEFAULT_BOOK_FILE_NAME                  "book.bin"              // 19.10.2026
+#define DEFAULT_POLYGLOT_BOOK_FILE_NAME         "polyglot.bin"
 #define DEFAULT_NNUE_FILE_NAME                  "net-7342fb032855.nnue" // 26.05.2025
 
 // Time management (Xiphos)
@@ -106,13 +111,21 @@
 #define DEFAULT_REDUCE_TIME                     25      // Milliseconds
 #define MAX_REDUCE_TIME                         1000    // Milliseconds
 
+#define REDUCE_TIME_SAMPLES                     16      // Auto reduce time: the last moves
+#define REDUCE_TIME_MIN_SAMPLES                 4
+#define REDUCE_TIME_PERCENTILE                  90
+#define REDUCE_TIME_MARGIN                      5       // Milliseconds
+
 #define MAX_MOVES_TO_GO                         40
 #define MAX_TIME_MOVES_TO_GO                    3
 
-#define MAX_TIME_STEPS                          10
+#define MAX_BEST_MOVE_STABILITY                 9       // Iterations with the same best move
+
+#define MIN_STABILITY_RATIO                     0.5     // Best move not changed (max. stability)
+#define MAX_STABILITY_RATIO                     1.2     // Best move changed
 
-#define MIN_TIME_RATIO                          0.5
-#define MAX_TIME_RATIO                          1.2
+#define MIN_NODE_SHARE_RATIO                    0.7     // All root nodes are spent on the best move
+#define MAX_NODE_SHARE_RATIO                    1.3     // No root nodes are spent on the best move
 
 #define MIN_SEARCH_DEPTH                        4
 
@@ -11,13 +11,19 @@
 #include "Hash.h"
 #include "Heuristic.h"
 #include "Move.h"
+#include "Polyglot.h"
 #include "Search.h"
+#include "Statistic.h"
+#include "Trace.h"
 #include "Types.h"
 #include "Utils.h"
 
 int MaxThreads;
 int MaxDepth;
 U64 MaxTime;
+U64 MaxNodes; // 0 = no limit
+
+U64 NodesCheckpoint; // Master thread
 
 U64 ReduceTime = (U64)DEFAULT_REDUCE_TIME;
 
@@ -27,13 +33,21 @@ U64 TimeStart;
 U64 TimeStop;
 U64 TotalTime;
 
-int TimeStep;
-U64 TargetTime[MAX_TIME_STEPS];
+U64 BestMoveTime; // UCI: "bestmove" output
+
+U64 TargetTime;
 
 int CompletedDepth;
 
+DepthInfoItem DepthInfo[MAX_PLY + 1];
+
 volatile BOOL StopSearch;
 
+volatile int SearchState = SEARCH_STATE_IDLE;
+
+SRWLOCK SearchStateLock = SRWLOCK_INIT;
+CONDITION_VARIABLE SearchStateChanged = CONDITION_VARIABLE_INIT;
+
 int PrintMode = PRINT_MODE_NORMAL;
 
 void PrintBestMoves(const BoardItem* Board, const int Depth, const MoveItem* BestMoves, const int BestScore)
@@ -42,6 +56,8 @@ void PrintBestMoves(const BoardItem* Board, const int Depth, const MoveItem* Bes
 
     TotalTime = CurrentTime - TimeStart;
 
+    _lock_file(stdout); // The line is not mixed with "readyok" (UCI input thread)
+
     if (PrintMode == PRINT_MODE_UCI) {
         printf("info depth %d seldepth %d nodes %llu time %llu", Depth, Board->SelDepth, Board->Nodes, TotalTime);
 
@@ -84,6 +100,8 @@ void PrintBestMoves(const BoardItem* Board, const int Depth, const MoveItem* Bes
     }
 
     printf("\n");
+
+    _unlock_file(stdout);
 }
 
 void SaveBestMoves(MoveItem* BestMoves, const MoveItem BestMove, const MoveItem* TempBestMoves)
@@ -104,6 +122,8 @@ BOOL PrintResult(const BOOL InCheck, const MoveItem BestMove, const MoveItem Pon
     char NotateMoveStr[16];
 
     if (PrintMode == PRINT_MODE_UCI) {
+        _lock_file(stdout); // The lines are not mixed with "readyok" (UCI input thread)
+
         printf("info nodes %llu", CurrentBoard.Nodes);
 
         if (TotalTime >= 1000ULL) {
@@ -137,6 +157,10 @@ BOOL PrintResult(const BOOL InCheck, const MoveItem BestMove, const MoveItem Pon
 
         printf("\n");
 
+        _unlock_file(stdout);
+
+        BestMoveTime = Clock();
+
         return FALSE;
     }
     else if (PrintMode == PRINT_MODE_NORMAL) {
@@ -191,11 +215,11 @@ BOOL PrintResult(const BOOL InCheck, const MoveItem BestMove, const MoveItem Pon
 
         printf("\n");
 
-#ifdef USE_STATISTIC
-        printf("\n");
+        if (UseStatistic) {
+            printf("\n");
 
-        printf("Hash count %llu Evaluate count %llu Cutoff count %llu Quiescence count %llu\n", CurrentBoard.HashCount, CurrentBoard.EvaluateCount, CurrentBoard.CutoffCount, CurrentBoard.QuiescenceCount);
-#endif // USE_STATISTIC
+            PrintStatistic(stdout, &CurrentBoard.Statistic, CurrentBoard.Nodes, TotalTime);
+        }
 
         if (BestScore <= -INF + 1 || BestScore >= INF - 1) { // Checkmate
             printf("\n");
@@ -241,6 +265,38 @@ BOOL PrintResult(const BOOL InCheck, const MoveItem BestMove, const MoveItem Pon
     }
 }
 
+U64 SearchedNodes(void) // Completed depths of all threads and current depths of all threads
+{
+    U64 Nodes = CurrentBoard.Nodes;
+
+    for (int Thread = 0; Thread < omp_get_num_threads(); ++Thread) {
+        Nodes += ThreadBoardList[Thread].Nodes;
+    }
+
+    return Nodes;
+}
+
+BOOL IsNodeLimitReached(const BoardItem* Board) // Master thread
+{
+    U64 Nodes = CurrentBoard.Nodes + Board->Nodes; // Helper threads are counted at the checkpoint
+
+    if (Nodes < NodesCheckpoint) {
+        return FALSE;
+    }
+
+    Nodes = SearchedNodes();
+
+    if (Nodes >= MaxNodes) {
+        return TRUE;
+    }
+
+    // Next checkpoint: the rest of the limit (one thread) or 4096 nodes of the master thread
+
+    NodesCheckpoint = CurrentBoard.Nodes + Board->Nodes + MIN(MaxNodes - Nodes, 4096ULL);
+
+    return FALSE;
+}
+
 BOOL ComputerMove(void)
 {
     BOOL InCheck;
@@ -261,28 +317,35 @@ BOOL ComputerMove(void)
 
     int BestScore = 0;
 
+    int LastBestMove = 0;
+    int BestMoveStability = 0; // Iterations with the same best move
+
+    double NodeShare; // Root nodes spent on the best move
+
     MoveItem BestMove;
     MoveItem PonderMove;
 
+    MoveItem LegalMoveList[MAX_GEN_MOVES];
+    int LegalMoveCount;
+
+    AcquireSRWLockExclusive(&SearchStateLock); // "ponderhit" and "stop" (UCI) may come before the search is started
+
     TimeStart = Clock();
-    TimeStop = TimeStart + MaxTime;
+    TimeStop = (SearchState == SEARCH_STATE_PONDERING) ? ULLONG_MAX : TimeStart + MaxTime;
+
+    StopSearch = (SearchState == SEARCH_STATE_STOPPING);
 
-    TimeStep = 0;
+    ReleaseSRWLockExclusive(&SearchStateLock);
 
     CompletedDepth = 0;
 
-    StopSearch = FALSE;
+    NodesCheckpoint = 0ULL;
 
     InCheck = IsInCheck(&CurrentBoard, CurrentBoard.CurrentColor);
 
     CurrentBoard.Nodes = 0ULL;
 
-#ifdef USE_STATISTIC
-    CurrentBoard.HashCount = 0ULL;
-    CurrentBoard.EvaluateCount = 0ULL;
-    CurrentBoard.CutoffCount = 0ULL;
-    CurrentBoard.QuiescenceCount = 0ULL;
-#endif // USE_STATISTIC
+    ClearStatistic(&CurrentBoard.Statistic);
 
     CurrentBoard.SelDepth = 0;
 
@@ -300,7 +363,7 @@ BOOL ComputerMove(void)
 
     AddHashStoreIteration();
 
-    if (GetBookMove(&CurrentBoard, CurrentBoard.BestMovesRoot)) {
+    if (GetBookMove(&CurrentBoard, Rand64(), CurrentBoard.BestMovesRoot) || GetPolyglotBookMove(&CurrentBoard, Rand64(), CurrentBoard.BestMovesRoot)) {
         goto Done;
     }
 
@@ -309,9 +372,9 @@ BOOL ComputerMove(void)
     }
 
 #ifdef ASPIRATION_WINDOW
-#pragma omp parallel private(ThreadId, ThreadBoard, ThreadScore, Alpha, Beta, Delta, TargetTimeLocal)
+#pragma omp parallel private(ThreadId, ThreadBoard, ThreadScore, Alpha, Beta, Delta, TargetTimeLocal, NodeShare)
 #else
-#pragma omp parallel private(ThreadId, ThreadBoard, ThreadScore, TargetTimeLocal)
+#pragma omp parallel private(ThreadId, ThreadBoard, ThreadScore, TargetTimeLocal, NodeShare)
 #endif // ASPIRATION_WINDOW
     {
         ThreadId = omp_get_thread_num();
@@ -332,12 +395,7 @@ BOOL ComputerMove(void)
 */
             ThreadBoard->Nodes = 0ULL;
 
-#ifdef USE_STATISTIC
-            ThreadBoard->HashCount = 0ULL;
-            ThreadBoard->EvaluateCount = 0ULL;
-            ThreadBoard->CutoffCount = 0ULL;
-            ThreadBoard->QuiescenceCount = 0ULL;
-#endif // USE_STATISTIC
+            ClearStatistic(&ThreadBoard->Statistic);
 
             ThreadBoard->SelDepth = 0;
 
@@ -383,12 +441,7 @@ BOOL ComputerMove(void)
 
                 CurrentBoard.Nodes += ThreadBoard->Nodes;
 
-#ifdef USE_STATISTIC
-                CurrentBoard.HashCount += ThreadBoard->HashCount;
-                CurrentBoard.EvaluateCount += ThreadBoard->EvaluateCount;
-                CurrentBoard.CutoffCount += ThreadBoard->CutoffCount;
-                CurrentBoard.QuiescenceCount += ThreadBoard->QuiescenceCount;
-#endif // USE_STATISTIC
+                AddStatistic(&CurrentBoard.Statistic, &ThreadBoard->Statistic);
 
                 CurrentBoard.SelDepth = MAX(CurrentBoard.SelDepth, ThreadBoard->SelDepth);
             }
@@ -411,9 +464,18 @@ BOOL ComputerMove(void)
                     }
 
                     PrintBestMoves(&CurrentBoard, CompletedDepth, CurrentBoard.BestMovesRoot, ThreadScore);
+
+                    DepthInfo[CompletedDepth].Time = Clock() - TimeStart;
+                    DepthInfo[CompletedDepth].Nodes = CurrentBoard.Nodes; // Thread nodes are already added (each thread at the end of its depth)
+
+                    DepthInfo[CompletedDepth].HashProbes = CurrentBoard.Statistic.Counter[STAT_HASH_PROBE] + CurrentBoard.Statistic.Counter[STAT_QUIESCENCE_HASH_PROBE];
+                    DepthInfo[CompletedDepth].HashHits = CurrentBoard.Statistic.Counter[STAT_HASH_HIT] + CurrentBoard.Statistic.Counter[STAT_QUIESCENCE_HASH_HIT];
+
+                    DepthInfo[CompletedDepth].Move = CurrentBoard.BestMovesRoot[0].Move;
+                    DepthInfo[CompletedDepth].Score = ThreadScore;
                 }
 
-                TargetTimeLocal = TargetTime[TimeStep];
+                TargetTimeLocal = TargetTime;
 
                 if (TargetTimeLocal > 0ULL && BestScore > ThreadScore) {
                     TargetTimeLocal = (U64)((double)TargetTimeLocal * MIN((1.0 + (double)(BestScore - ThreadScore) / 80.0), 2.0));
@@ -421,7 +483,31 @@ BOOL ComputerMove(void)
 
                 BestScore = ThreadScore;
 
-                if (TargetTimeLocal > 0ULL && CompletedDepth >= MIN_SEARCH_DEPTH && (Clock() - TimeStart) >= TargetTimeLocal) { // Time is up
+                // Best move stability and node share: less time for an easy move, more time for an unstable position (bounded by max. time)
+
+                if (CurrentBoard.BestMovesRoot[0].Move == LastBestMove) {
+                    BestMoveStability = MIN(BestMoveStability + 1, MAX_BEST_MOVE_STABILITY);
+                }
+                else {
+                    BestMoveStability = 0;
+                }
+
+                LastBestMove = CurrentBoard.BestMovesRoot[0].Move;
+
+                if (TargetTimeLocal > 0ULL) {
+                    NodeShare = (ThreadBoard->Nodes > ThreadBoard->RootNodes) ? MIN((double)ThreadBoard->BestMoveNodes / (double)(ThreadBoard->Nodes - ThreadBoard->RootNodes), 1.0) : 0.0; // The last search (not aspiration window re-searches)
+
+                    TargetTimeLocal = (U64)((double)TargetTimeLocal * (MAX_STABILITY_RATIO - (MAX_STABILITY_RATIO - MIN_STABILITY_RATIO) * BestMoveStability / MAX_BEST_MOVE_STABILITY));
+                    TargetTimeLocal = (U64)((double)TargetTimeLocal * (MAX_NODE_SHARE_RATIO - (MAX_NODE_SHARE_RATIO - MIN_NODE_SHARE_RATIO) * NodeShare));
+
+                    TargetTimeLocal = MIN(TargetTimeLocal, MaxTime);
+                }
+
+                if (MaxNodes > 0ULL && CurrentBoard.Nodes >= MaxNodes) { // Node limit
+                    break; // for (depth)
+                }
+
+                if (TargetTimeLocal > 0ULL && CompletedDepth >= MIN_SEARCH_DEPTH && SearchState != SEARCH_STATE_PONDERING && (Clock() - TimeStart) >= TargetTimeLocal) { // Time is up
                     break; // for (depth)
                 }
             }
@@ -442,9 +528,31 @@ BOOL ComputerMove(void)
 
 Done:
 
+    // Pondering: the best move is sent after "ponderhit" or "stop"
+
+    AcquireSRWLockExclusive(&SearchStateLock);
+
+    while (SearchState == SEARCH_STATE_PONDERING) {
+        SleepConditionVariableSRW(&SearchStateChanged, &SearchStateLock, INFINITE, 0);
+    }
+
+    ReleaseSRWLockExclusive(&SearchStateLock);
+
     TimeStop = Clock();
     TotalTime = TimeStop - TimeStart;
 
+    if (!CurrentBoard.BestMovesRoot[0].Move) { // Stopped before the first depth is completed (or no legal moves)
+        LegalMoveCount = 0;
+        GenerateAllLegalMoves(&CurrentBoard, NULL, LegalMoveList, &LegalMoveCount);
+
+        for (int MoveNumber = 0; MoveNumber < LegalMoveCount; ++MoveNumber) { // The first legal move in sort order
+            if (MoveNumber == 0 || LegalMoveList[MoveNumber].SortValue > CurrentBoard.BestMovesRoot[0].SortValue) {
+                CurrentBoard.BestMovesRoot[0] = LegalMoveList[MoveNumber];
+                CurrentBoard.BestMovesRoot[1] = (MoveItem){ 0, 0, 0 }; // End of move list
+            }
+        }
+    }
+
     BestMove = CurrentBoard.BestMovesRoot[0];
     PonderMove = CurrentBoard.BestMovesRoot[1];
 
@@ -455,9 +563,78 @@ void ComputerMoveThread(void* ignored)
 {
     ComputerMove();
 
+    if (TraceSaveRequest) {
+        SaveTrace(TRACE_FILE_NAME);
+
+        TraceSaveRequest = FALSE;
+    }
+
+    AcquireSRWLockExclusive(&SearchStateLock);
+
+    SearchState = SEARCH_STATE_IDLE;
+
+    WakeAllConditionVariable(&SearchStateChanged);
+
+    ReleaseSRWLockExclusive(&SearchStateLock);
+
     _endthread();
 }
 
+void SearchStart(const BOOL Ponder) // Idle -> searching (pondering)
+{
+    SearchWait(); // One search at a time
+
+    AcquireSRWLockExclusive(&SearchStateLock);
+
+    SearchState = Ponder ? SEARCH_STATE_PONDERING : SEARCH_STATE_SEARCHING;
+
+    ReleaseSRWLockExclusive(&SearchStateLock);
+
+    _beginthread(ComputerMoveThread, 0, NULL);
+}
+
+void SearchPonderHit(void) // Pondering -> searching (the time is counted from "ponderhit")
+{
+    AcquireSRWLockExclusive(&SearchStateLock);
+
+    if (SearchState == SEARCH_STATE_PONDERING) {
+        TimeStart = Clock();
+        TimeStop = TimeStart + MaxTime;
+
+        SearchState = SEARCH_STATE_SEARCHING;
+
+        WakeAllConditionVariable(&SearchStateChanged);
+    }
+
+    ReleaseSRWLockExclusive(&SearchStateLock);
+}
+
+void SearchStop(void) // Searching (pondering) -> stopping
+{
+    AcquireSRWLockExclusive(&SearchStateLock);
+
+    if (SearchState == SEARCH_STATE_SEARCHING || SearchState == SEARCH_STATE_PONDERING) {
+        StopSearch = TRUE;
+
+        SearchState = SEARCH_STATE_STOPPING;
+
+        WakeAllConditionVariable(&SearchStateChanged);
+    }
+
+    ReleaseSRWLockExclusive(&SearchStateLock);
+}
+
+void SearchWait(void) // Until idle (the best move is sent)
+{
+    AcquireSRWLockExclusive(&SearchStateLock);
+
+    while (SearchState != SEARCH_STATE_IDLE) {
+        SleepConditionVariableSRW(&SearchStateChanged, &SearchStateLock, INFINITE, 0);
+    }
+
+    ReleaseSRWLockExclusive(&SearchStateLock);
+}
+
 BOOL HumanMove(void)
 {
     char ReadStr[64];
@@ -474,12 +651,12 @@ BOOL HumanMove(void)
     char NotateMoveStr[16];
 
     int GenMoveCount;
-    MoveItem MoveList[MAX_GEN_MOVES];
+    MoveListItem MoveList;
 
     BOOL InCheck = IsInCheck(&CurrentBoard, CurrentBoard.CurrentColor);
 
     GenMoveCount = 0;
-    GenerateAllMoves(&CurrentBoard, NULL, MoveList, &GenMoveCount);
+    GenerateAllMoves(&CurrentBoard, NULL, &MoveList, &GenMoveCount);
 
     while (TRUE) {
         ReadStr[0] = '\0'; // Nul
@@ -503,7 +680,7 @@ BOOL HumanMove(void)
             InCheck = IsInCheck(&CurrentBoard, CurrentBoard.CurrentColor);
 
             GenMoveCount = 0;
-            GenerateAllMoves(&CurrentBoard, NULL, MoveList, &GenMoveCount);
+            GenerateAllMoves(&CurrentBoard, NULL, &MoveList, &GenMoveCount);
 
             continue; // Next string
         }
@@ -548,10 +725,10 @@ BOOL HumanMove(void)
             Move = MOVE_CREATE(From, To, PromotePieceType);
 
             for (int MoveNumber = 0; MoveNumber < GenMoveCount; ++MoveNumber) {
-                if (MoveList[MoveNumber].Move == Move) {
-                    NotateMove(&CurrentBoard, MoveList[MoveNumber], NotateMoveStr);
+                if (MoveList.Move[MoveNumber] == Move) {
+                    NotateMove(&CurrentBoard, CreateMoveItem(&CurrentBoard, MoveList.Move[MoveNumber]), NotateMoveStr);
 
-                    MakeMove(&CurrentBoard, MoveList[MoveNumber]);
+                    MakeMove(&CurrentBoard, CreateMoveItem(&CurrentBoard, MoveList.Move[MoveNumber]));
 
                     if (IsInCheck(&CurrentBoard, CHANGE_COLOR(CurrentBoard.CurrentColor))) { // Illegal move
                         UnmakeMove(&CurrentBoard);
@@ -564,14 +741,14 @@ BOOL HumanMove(void)
                     printf("\n");
 
                     if (CurrentBoard.CurrentColor == WHITE) {
-                        printf("%d: ... %s%s", CurrentBoard.HalfMoveNumber / 2, BoardName[MOVE_FROM(MoveList[MoveNumber].Move)], BoardName[MOVE_TO(MoveList[MoveNumber].Move)]);
+                        printf("%d: ... %s%s", CurrentBoard.HalfMoveNumber / 2, BoardName[MOVE_FROM(MoveList.Move[MoveNumber])], BoardName[MOVE_TO(MoveList.Move[MoveNumber])]);
                     }
                     else { // BLACK
-                        printf("%d: %s%s", CurrentBoard.HalfMoveNumber / 2 + 1, BoardName[MOVE_FROM(MoveList[MoveNumber].Move)], BoardName[MOVE_TO(MoveList[MoveNumber].Move)]);
+                        printf("%d: %s%s", CurrentBoard.HalfMoveNumber / 2 + 1, BoardName[MOVE_FROM(MoveList.Move[MoveNumber])], BoardName[MOVE_TO(MoveList.Move[MoveNumber])]);
                     }
 
-                    if (MoveList[MoveNumber].Type & MOVE_PAWN_PROMOTE) {
-                        printf("%c", PiecesCharBlack[MOVE_PROMOTE_PIECE_TYPE(MoveList[MoveNumber].Move)]);
+                    if (MOVE_PROMOTE_PIECE_TYPE(MoveList.Move[MoveNumber])) {
+                        printf("%c", PiecesCharBlack[MOVE_PROMOTE_PIECE_TYPE(MoveList.Move[MoveNumber])]);
                     }
 
                     printf(" (%s)\n", NotateMoveStr);
@@ -634,9 +811,11 @@ void InputParametrs(void)
         MaxTime = 1ULL;
     }
 
+    MaxNodes = 0ULL;
+
     TimeForMove = 0ULL;
 
-    memset(TargetTime, 0, sizeof(TargetTime));
+    TargetTime = 0ULL;
 
     printf("Hash table size (min. 1 max. %d; 0 = %d), Mb: ", MAX_HASH_TABLE_SIZE, DEFAULT_HASH_TABLE_SIZE);
     scanf_s("%d", &InputHashSize);
@@ -13,9 +13,28 @@
 #define PRINT_MODE_UCI      1
 #define PRINT_MODE_TESTS    2
 
+// Search controller (UCI)
+
+#define SEARCH_STATE_IDLE       0
+#define SEARCH_STATE_SEARCHING  1
+#define SEARCH_STATE_PONDERING  2   // "go ponder": time is not used and the best move is not sent until "ponderhit" or "stop"
+#define SEARCH_STATE_STOPPING   3
+
+typedef struct {
+    U64 Time;           // Milliseconds since the start of the search
+    U64 Nodes;          // All threads
+
+    U64 HashProbes;     // Search and quiescence search (statistic is used)
+    U64 HashHits;
+
+    int Move;
+    int Score;
+} DepthInfoItem;
+
 extern int MaxThreads;
 extern int MaxDepth;
 extern U64 MaxTime;
+extern U64 MaxNodes;
 
 extern U64 ReduceTime;
 
@@ -25,21 +44,34 @@ extern U64 TimeStart;
 extern U64 TimeStop;
 extern U64 TotalTime;
 
-extern int TimeStep;
-extern U64 TargetTime[MAX_TIME_STEPS];
+extern U64 BestMoveTime;
+
+extern U64 TargetTime;
 
 extern int CompletedDepth;
 
+extern DepthInfoItem DepthInfo[MAX_PLY + 1]; // Completed depths
+
 extern volatile BOOL StopSearch;
 
+extern volatile int SearchState;
+
 extern int PrintMode;
 
 void PrintBestMoves(const BoardItem* Board, const int Depth, const MoveItem* BestMoves, const int BestScore);
 void SaveBestMoves(MoveItem* BestMoves, const MoveItem BestMove, const MoveItem* TempBestMoves);
 
+U64 SearchedNodes(void);
+BOOL IsNodeLimitReached(const BoardItem* Board);
+
 BOOL ComputerMove(void);
 void ComputerMoveThread(void* ignored);
 
+void SearchStart(const BOOL Ponder);
+void SearchPonderHit(void);
+void SearchStop(void);
+void SearchWait(void);
+
 BOOL HumanMove(void);
 
 void InputParametrs(void);
@@ -10,77 +10,79 @@
 #include "Heuristic.h"
 #include "Move.h"
 #include "Sort.h"
+#include "Trace.h"
 #include "Types.h"
 
-void AddMove(const BoardItem* Board, int** CMH_Pointer, MoveItem* MoveList, int* GenMoveCount, const int From, const int To, const int MoveType)
+void AddMove(const BoardItem* Board, int** CMH_Pointer, MoveListItem* MoveList, int* GenMoveCount, const int From, const int To, const int MoveType)
 {
     if ((MoveType & MOVE_PAWN) && (RANK(To) == 0 || RANK(To) == 7)) { // Pawn promote
         // Knight
 
-        MoveList[*GenMoveCount].Type = (MoveType | MOVE_PAWN_PROMOTE);
-        MoveList[*GenMoveCount].Move = MOVE_CREATE(From, To, KNIGHT);
-        MoveList[*GenMoveCount].SortValue = SORT_PAWN_PROMOTE_MOVE_BONUS + KNIGHT;
+        MoveList->Move[*GenMoveCount] = (U16)MOVE_CREATE(From, To, KNIGHT);
+        MoveList->SortValue[*GenMoveCount] = SORT_PAWN_PROMOTE_MOVE_BONUS + KNIGHT;
 
         ++(*GenMoveCount);
 
         // Bishop
 
-        MoveList[*GenMoveCount].Type = (MoveType | MOVE_PAWN_PROMOTE);
-        MoveList[*GenMoveCount].Move = MOVE_CREATE(From, To, BISHOP);
-        MoveList[*GenMoveCount].SortValue = SORT_PAWN_PROMOTE_MOVE_BONUS + BISHOP;
+        MoveList->Move[*GenMoveCount] = (U16)MOVE_CREATE(From, To, BISHOP);
+        MoveList->SortValue[*GenMoveCount] = SORT_PAWN_PROMOTE_MOVE_BONUS + BISHOP;
 
         ++(*GenMoveCount);
 
         // Rook
 
-        MoveList[*GenMoveCount].Type = (MoveType | MOVE_PAWN_PROMOTE);
-        MoveList[*GenMoveCount].Move = MOVE_CREATE(From, To, ROOK);
-        MoveList[*GenMoveCount].SortValue = SORT_PAWN_PROMOTE_MOVE_BONUS + ROOK;
+        MoveList->Move[*GenMoveCount] = (U16)MOVE_CREATE(From, To, ROOK);
+        MoveList->SortValue[*GenMoveCount] = SORT_PAWN_PROMOTE_MOVE_BONUS + ROOK;
 
         ++(*GenMoveCount);
 
         // Queen
 
-        MoveList[*GenMoveCount].Type = (MoveType | MOVE_PAWN_PROMOTE);
-        MoveList[*GenMoveCount].Move = MOVE_CREATE(From, To, QUEEN);
-        MoveList[*GenMoveCount].SortValue = SORT_PAWN_PROMOTE_MOVE_BONUS + QUEEN;
+        MoveList->Move[*GenMoveCount] = (U16)MOVE_CREATE(From, To, QUEEN);
+        MoveList->SortValue[*GenMoveCount] = SORT_PAWN_PROMOTE_MOVE_BONUS + QUEEN;
 
         ++(*GenMoveCount);
     }
     else {
-        MoveList[*GenMoveCount].Type = MoveType;
-        MoveList[*GenMoveCount].Move = MOVE_CREATE(From, To, 0);
+        MoveList->Move[*GenMoveCount] = (U16)MOVE_CREATE(From, To, 0);
 
         if (MoveType & MOVE_CAPTURE) {
             if (MoveType & MOVE_PAWN_PASSANT) {
-                MoveList[*GenMoveCount].SortValue = SORT_CAPTURE_MOVE_BONUS + ((PAWN + 1) << 3) - (PAWN + 1);
+                MoveList->SortValue[*GenMoveCount] = SORT_CAPTURE_MOVE_BONUS + ((PAWN + 1) << 3) - (PAWN + 1);
             }
             else {
-                MoveList[*GenMoveCount].SortValue = SORT_CAPTURE_MOVE_BONUS + ((PIECE_TYPE(Board->Pieces[To]) + 1) << 3) - (PIECE_TYPE(Board->Pieces[From]) + 1);
+                MoveList->SortValue[*GenMoveCount] = SORT_CAPTURE_MOVE_BONUS + ((PIECE_TYPE(Board->Pieces[To]) + 1) << 3) - (PIECE_TYPE(Board->Pieces[From]) + 1);
             }
         }
         else {
-            MoveList[*GenMoveCount].SortValue = Board->HeuristicTable[Board->CurrentColor][PIECE_TYPE(Board->Pieces[From])][To];
+#ifdef USE_SORT_AVX2
+            MoveList->SortValue[*GenMoveCount] = 0; // See SetQuietMoveSortValues()
+#else
+            MoveList->SortValue[*GenMoveCount] = Board->HeuristicTable[Board->CurrentColor][PIECE_TYPE(Board->Pieces[From])][To];
 
 #ifdef COUNTER_MOVE_HISTORY
             if (CMH_Pointer) {
                 if (CMH_Pointer[0]) {
-                    MoveList[*GenMoveCount].SortValue += CMH_Pointer[0][(PIECE_TYPE(Board->Pieces[From]) << 6) + To];
+                    MoveList->SortValue[*GenMoveCount] += CMH_Pointer[0][(PIECE_TYPE(Board->Pieces[From]) << 6) + To];
                 }
 
                 if (CMH_Pointer[1]) {
-                    MoveList[*GenMoveCount].SortValue += CMH_Pointer[1][(PIECE_TYPE(Board->Pieces[From]) << 6) + To];
+                    MoveList->SortValue[*GenMoveCount] += CMH_Pointer[1][(PIECE_TYPE(Board->Pieces[From]) << 6) + To];
                 }
             }
 #endif // COUNTER_MOVE_HISTORY
+#endif // USE_SORT_AVX2
         }
 
         ++(*GenMoveCount);
     }
 }
 
-void GenerateAllMoves(const BoardItem* Board, int** CMH_Pointer, MoveItem* MoveList, int* GenMoveCount)
+void GenerateAllMoves(const BoardItem* Board, int** CMH_Pointer, MoveListItem* MoveList, int* GenMoveCount)
 {
+    U64 TraceTime = TRACE_START();
+
     U64 Pieces;
     U64 Attacks;
 
@@ -382,10 +384,18 @@ void GenerateAllMoves(const BoardItem* Board, int** CMH_Pointer, MoveItem* MoveL
             AddMove(Board, CMH_Pointer, MoveList, GenMoveCount, SQ_E8, SQ_C8, MOVE_CASTLE_QUEEN);
         }
     }
+
+#ifdef USE_SORT_AVX2
+    SetQuietMoveSortValues(Board, CMH_Pointer, MoveList, *GenMoveCount);
+#endif // USE_SORT_AVX2
+
+    TRACE_STOP(TRACE_GENERATE_ALL_MOVES, TraceTime);
 }
 
-void GenerateCaptureMoves(const BoardItem* Board, int** CMH_Pointer, MoveItem* MoveList, int* GenMoveCount)
+void GenerateCaptureMoves(const BoardItem* Board, int** CMH_Pointer, MoveListItem* MoveList, int* GenMoveCount)
 {
+    U64 TraceTime = TRACE_START();
+
     U64 Pieces;
     U64 Attacks;
 
@@ -585,21 +595,28 @@ void GenerateCaptureMoves(const BoardItem* Board, int** CMH_Pointer, MoveItem* M
 
         CaptureMoves &= CaptureMoves - 1;
     }
+
+    TRACE_STOP(TRACE_GENERATE_CAPTURE_MOVES, TraceTime);
 }
 
 void GenerateAllLegalMoves(BoardItem* Board, int** CMH_Pointer, MoveItem* LegalMoveList, int* LegalMoveCount)
 {
     int GenMoveCount;
-    MoveItem MoveList[MAX_GEN_MOVES];
+    MoveListItem MoveList;
+
+    MoveItem Move;
 
     GenMoveCount = 0;
-    GenerateAllMoves(Board, CMH_Pointer, MoveList, &GenMoveCount);
+    GenerateAllMoves(Board, CMH_Pointer, &MoveList, &GenMoveCount);
 
     for (int MoveNumber = 0; MoveNumber < GenMoveCount; ++MoveNumber) {
-        MakeMove(Board, MoveList[MoveNumber]);
+        Move = CreateMoveItem(Board, MoveList.Move[MoveNumber]);
+        Move.SortValue = MoveList.SortValue[MoveNumber];
+
+        MakeMove(Board, Move);
 
         if (!IsInCheck(Board, CHANGE_COLOR(Board->CurrentColor))) { // Legal move
-            LegalMoveList[(*LegalMoveCount)++] = MoveList[MoveNumber];
+            LegalMoveList[(*LegalMoveCount)++] = Move;
         }
 
         UnmakeMove(Board);
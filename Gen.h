@@ -8,8 +8,8 @@
 #include "Board.h"
 #include "Def.h"
 
-void GenerateAllMoves(const BoardItem* Board, int** CMH_Pointer, MoveItem* MoveList, int* GenMoveCount);
-void GenerateCaptureMoves(const BoardItem* Board, int** CMH_Pointer, MoveItem* MoveList, int* GenMoveCount);
+void GenerateAllMoves(const BoardItem* Board, int** CMH_Pointer, MoveListItem* MoveList, int* GenMoveCount);
+void GenerateCaptureMoves(const BoardItem* Board, int** CMH_Pointer, MoveListItem* MoveList, int* GenMoveCount);
 
 void GenerateAllLegalMoves(BoardItem* Board, int** CMH_Pointer, MoveItem* LegalMoveList, int* LegalMoveCount);
 
@@ -6,6 +6,7 @@
 
 #include "BitBoard.h"
 #include "Def.h"
+#include "Trace.h"
 #include "Types.h"
 #include "Utils.h"
 
@@ -17,48 +18,70 @@ U64 PieceHash[2][6][64];    // [Color][Piece][Square]
 U64 ColorHash;
 U64 PassantHash[64];        // [Square]
 
-void InitHashTable(const int SizeInMb) // Xiphos
+#ifdef UPCOMING_REPETITION
+U64 CuckooKey[CUCKOO_SIZE];
+int CuckooMove[CUCKOO_SIZE];    // (PieceType << 12) | (From << 6) | To
+#endif // UPCOMING_REPETITION
+
+BOOL InitHashStore(HashStoreItem* Store, const int SizeInMb) // Xiphos
 {
     U64 Items;
     U64 RoundItems = 1ULL;
 
-    FreeHashTable(); // The hash table may have been initialized earlier
-
     Items = ((U64)SizeInMb << 20) / sizeof(HashItem);
 
     while (Items >>= 1) {
         RoundItems <<= 1;
     }
 
-    HashStore.Size = RoundItems * sizeof(HashItem);
-    HashStore.Mask = RoundItems - 1;
+    Store->Size = RoundItems * sizeof(HashItem);
+    Store->Mask = RoundItems - 1;
 
-    HashStore.Iteration = 0;
+    Store->Iteration = 0;
 
-    HashStore.Item = (HashItem*)calloc(RoundItems, sizeof(HashItem));
+    Store->Item = (HashItem*)calloc(RoundItems, sizeof(HashItem));
 
-    if (HashStore.Item == NULL) { // Allocate memory error
+    if (Store->Item == NULL) { // Allocate memory error
         printf("Allocate memory to hash table error!\n");
 
-        return;
+        return FALSE;
     }
 
-    HashTableInitialized = TRUE;
+    return TRUE;
+}
+
+void ClearHashStore(HashStoreItem* Store)
+{
+    Store->Iteration = 0;
+
+    memset(Store->Item, 0, Store->Size);
+}
+
+void FreeHashStore(HashStoreItem* Store)
+{
+    free(Store->Item);
+
+    Store->Item = NULL;
+}
+
+void InitHashTable(const int SizeInMb)
+{
+    FreeHashTable(); // The hash table may have been initialized earlier
+
+    HashTableInitialized = InitHashStore(&HashStore, SizeInMb);
 }
 
 void ClearHashTable(void)
 {
     if (HashTableInitialized) {
-        HashStore.Iteration = 0;
-
-        memset(HashStore.Item, 0, HashStore.Size);
+        ClearHashStore(&HashStore);
     }
 }
 
 void FreeHashTable(void)
 {
     if (HashTableInitialized) {
-        free(HashStore.Item);
+        FreeHashStore(&HashStore);
 
         HashTableInitialized = FALSE;
     }
@@ -69,6 +92,79 @@ BOOL IsHashTableInitialized(void)
     return HashTableInitialized;
 }
 
+#ifdef UPCOMING_REPETITION
+void InitCuckooTables(void) // Stockfish
+{
+    U64 Attack;
+
+    U64 Key;
+    U64 TempKey;
+
+    int Move;
+    int TempMove;
+
+    int Index;
+
+    memset(CuckooKey, 0, sizeof(CuckooKey));
+    memset(CuckooMove, 0, sizeof(CuckooMove));
+
+    for (int Color = 0; Color < 2; ++Color) { // White/Black
+        for (int Piece = KNIGHT; Piece <= KING; ++Piece) { // NBRQK
+            for (int From = 0; From < 64; ++From) {
+                switch (Piece) {
+                    case KNIGHT:
+                        Attack = KnightAttacks(From);
+                        break;
+
+                    case BISHOP:
+                        Attack = BishopAttacks(From, 0ULL);
+                        break;
+
+                    case ROOK:
+                        Attack = RookAttacks(From, 0ULL);
+                        break;
+
+                    case QUEEN:
+                        Attack = QueenAttacks(From, 0ULL);
+                        break;
+
+                    default: // KING
+                        Attack = KingAttacks(From);
+                }
+
+                for (int To = From + 1; To < 64; ++To) {
+                    if (!(Attack & BB_SQUARE(To))) {
+                        continue; // Next square
+                    }
+
+                    Key = PieceHash[Color][Piece][From] ^ PieceHash[Color][Piece][To] ^ ColorHash;
+                    Move = MOVE_CREATE(From, To, Piece);
+
+                    Index = CUCKOO_H1(Key);
+
+                    while (TRUE) {
+                        TempKey = CuckooKey[Index];
+                        TempMove = CuckooMove[Index];
+
+                        CuckooKey[Index] = Key;
+                        CuckooMove[Index] = Move;
+
+                        Key = TempKey;
+                        Move = TempMove;
+
+                        if (!Move) { // Empty slot
+                            break; // while
+                        }
+
+                        Index = (Index == CUCKOO_H1(Key)) ? CUCKOO_H2(Key) : CUCKOO_H1(Key);
+                    }
+                }
+            }
+        }
+    }
+}
+#endif // UPCOMING_REPETITION
+
 void InitHashBoards(void)
 {
     for (int Color = 0; Color < 2; ++Color) { // White/Black
@@ -84,6 +180,10 @@ void InitHashBoards(void)
     for (int Square = 0; Square < 64; ++Square) {
         PassantHash[Square] = Rand64();
     }
+
+#ifdef UPCOMING_REPETITION
+    InitCuckooTables();
+#endif // UPCOMING_REPETITION
 }
 
 void InitHash(BoardItem* Board)
@@ -138,16 +238,18 @@ void AddHashStoreIteration(void)
     HashStore.Iteration = (HashStore.Iteration + (U8)1) & (U8)15; // 4 bits
 }
 
-void SaveHash(const U64 Hash, const int Depth, const int Ply, const int Score, const int StaticScore, const int Move, const int Flag)
+void SaveHash(HashStoreItem* Store, const U64 Hash, const int Depth, const int Ply, const int Score, const int StaticScore, const int Move, const int Flag)
 {
-    HashItem* HashItemPointer = &HashStore.Item[Hash & HashStore.Mask];
+    U64 TraceTime = TRACE_START();
+
+    HashItem* HashItemPointer = &Store->Item[Hash & Store->Mask];
 
     HashDataU DataU = HashItemPointer->Value; // Load data from record
 
     if (
         (HashItemPointer->KeyValue ^ Hash) == DataU.RawData
         || Depth >= DataU.Data.Depth
-        || DataU.Data.Iteration != HashStore.Iteration
+        || DataU.Data.Iteration != Store->Iteration
     ) { // Xiphos
         // Replace record
 
@@ -166,21 +268,27 @@ void SaveHash(const U64 Hash, const int Depth, const int Ply, const int Score, c
         DataU.Data.Move = (U16)Move;
         DataU.Data.Depth = (I8)Depth;
         DataU.Data.Flag = (U8)Flag;
-        DataU.Data.Iteration = HashStore.Iteration;
+        DataU.Data.Iteration = Store->Iteration;
 
         // Save record
         HashItemPointer->KeyValue = (Hash ^ DataU.RawData);
         HashItemPointer->Value = DataU;
     }
+
+    TRACE_STOP(TRACE_SAVE_HASH, TraceTime);
 }
 
-void LoadHash(const U64 Hash, int* Depth, const int Ply, int* Score, int* StaticScore, int* Move, int* Flag)
+void LoadHash(const HashStoreItem* Store, const U64 Hash, int* Depth, const int Ply, int* Score, int* StaticScore, int* Move, int* Flag)
 {
-    HashItem* HashItemPointer = &HashStore.Item[Hash & HashStore.Mask];
+    U64 TraceTime = TRACE_START();
+
+    HashItem* HashItemPointer = &Store->Item[Hash & Store->Mask];
 
     HashDataU DataU = HashItemPointer->Value; // Load data from record
 
     if ((HashItemPointer->KeyValue ^ Hash) != DataU.RawData) { // Hash does not match or data is corrupted (SMP)
+        TRACE_STOP(TRACE_LOAD_HASH, TraceTime);
+
         return;
     }
 
@@ -199,6 +307,8 @@ void LoadHash(const U64 Hash, int* Depth, const int Ply, int* Score, int* Static
     *Move = DataU.Data.Move;
     *Depth = DataU.Data.Depth;
     *Flag = DataU.Data.Flag;
+
+    TRACE_STOP(TRACE_LOAD_HASH, TraceTime);
 }
 
 int FullHash(void)
@@ -215,9 +325,9 @@ int FullHash(void)
 }
 
 #ifdef HASH_PREFETCH
-void Prefetch(const U64 Hash)
+void Prefetch(const HashStoreItem* Store, const U64 Hash)
 {
-    HashItem* HashItemPointer = &HashStore.Item[Hash & HashStore.Mask];
+    HashItem* HashItemPointer = &Store->Item[Hash & Store->Mask];
 
     _mm_prefetch((char*)HashItemPointer, _MM_HINT_T0);
 }
@@ -14,43 +14,29 @@
 #define HASH_BETA           4
 #define HASH_STATIC_SCORE   8
 
-typedef struct {
-    I16 Score;
-    I16 StaticScore;
+#ifdef UPCOMING_REPETITION
+#define CUCKOO_SIZE         8192
 
-    U16 Move;
+#define CUCKOO_H1(Key)      ((int)(Key) & (CUCKOO_SIZE - 1))
+#define CUCKOO_H2(Key)      ((int)((Key) >> 16) & (CUCKOO_SIZE - 1))
+#endif // UPCOMING_REPETITION
 
-    I8 Depth;
-
-    U8 Flag : 4, Iteration : 4;
-} HashDataS; // 8 bytes
-
-typedef union {
-    U64 RawData;
-
-    HashDataS Data;
-} HashDataU; // 8 bytes
-
-typedef struct {
-    U64 KeyValue;
-
-    HashDataU Value;
-} HashItem; // 16 bytes
-
-typedef struct {
-    U64 Size;
-    U64 Mask;
-
-    U8 Iteration; // 4 bits
-
-    HashItem* Item;
-} HashStoreItem;
+extern HashStoreItem HashStore;
 
 extern U64 PieceHash[2][6][64]; // [Color][Piece][Square]
 extern U64 ColorHash;
 extern U64 PassantHash[64];     // [Square]
 
-void InitHashTable(const int SizeInMb); // Xiphos
+#ifdef UPCOMING_REPETITION
+extern U64 CuckooKey[CUCKOO_SIZE];
+extern int CuckooMove[CUCKOO_SIZE]; // (PieceType << 12) | (From << 6) | To
+#endif // UPCOMING_REPETITION
+
+BOOL InitHashStore(HashStoreItem* Store, const int SizeInMb); // Xiphos
+void ClearHashStore(HashStoreItem* Store);
+void FreeHashStore(HashStoreItem* Store);
+
+void InitHashTable(const int SizeInMb);
 void ClearHashTable(void);
 void FreeHashTable(void);
 
@@ -62,13 +48,13 @@ void InitHash(BoardItem* Board);
 
 void AddHashStoreIteration(void);
 
-void SaveHash(const U64 Hash, const int Depth, const int Ply, const int Score, const int StaticScore, const int Move, const int Flag);
-void LoadHash(const U64 Hash, int* Depth, const int Ply, int* Score, int* StaticScore, int* Move, int* Flag);
+void SaveHash(HashStoreItem* Store, const U64 Hash, const int Depth, const int Ply, const int Score, const int StaticScore, const int Move, const int Flag);
+void LoadHash(const HashStoreItem* Store, const U64 Hash, int* Depth, const int Ply, int* Score, int* StaticScore, int* Move, int* Flag);
 
 int FullHash(void);
 
 #ifdef HASH_PREFETCH
-void Prefetch(const U64 Hash);
+void Prefetch(const HashStoreItem* Store, const U64 Hash);
 #endif // HASH_PREFETCH
 
 #endif // !HASH_H
\ No newline at end of file
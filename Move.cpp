@@ -9,10 +9,56 @@
 #include "Def.h"
 #include "Hash.h"
 #include "NNUE2.h"
+#include "Trace.h"
 #include "Types.h"
 
+int GetMoveType(const BoardItem* Board, const int Move)
+{
+    int From = MOVE_FROM(Move);
+    int To = MOVE_TO(Move);
+
+    int PieceTypeFrom = PIECE_TYPE(Board->Pieces[From]);
+
+    int MoveType = (Board->Pieces[To] != NO_PIECE) ? MOVE_CAPTURE : MOVE_QUIET;
+
+    if (PieceTypeFrom == PAWN) {
+        if (To == Board->PassantSquare) {
+            return (MOVE_PAWN_PASSANT | MOVE_CAPTURE);
+        }
+
+        if (MOVE_PROMOTE_PIECE_TYPE(Move)) {
+            return (MoveType | MOVE_PAWN | MOVE_PAWN_PROMOTE);
+        }
+
+        if (To - From == 16 || From - To == 16) {
+            return MOVE_PAWN_2;
+        }
+
+        return (MoveType | MOVE_PAWN);
+    }
+
+    if (PieceTypeFrom == KING) {
+        if (To - From == 2) {
+            return MOVE_CASTLE_KING;
+        }
+
+        if (From - To == 2) {
+            return MOVE_CASTLE_QUEEN;
+        }
+    }
+
+    return MoveType;
+}
+
+MoveItem CreateMoveItem(const BoardItem* Board, const int Move)
+{
+    return (MoveItem){ GetMoveType(Board, Move), Move, 0 };
+}
+
 void MakeMove(BoardItem* Board, const MoveItem Move)
 {
+    U64 TraceTime = TRACE_START();
+
     HistoryItem* Info = &Board->MoveTable[Board->HalfMoveNumber++];
 
     int From = MOVE_FROM(Move.Move);
@@ -46,6 +92,8 @@ void MakeMove(BoardItem* Board, const MoveItem Move)
 
     Info->Hash = Board->Hash;
 
+    ++Board->RepetitionFilter[Board->Hash & (REPETITION_FILTER_SIZE - 1)];
+
 #ifdef DEBUG_MOVE
     Info->BB_WhitePieces = Board->BB_WhitePieces;
     Info->BB_BlackPieces = Board->BB_BlackPieces;
@@ -283,6 +331,8 @@ void MakeMove(BoardItem* Board, const MoveItem Move)
 
     Board->Hash ^= ColorHash;
 
+    TRACE_STOP(TRACE_MAKE_MOVE, TraceTime);
+
 #ifdef DEBUG_NNUE
     I16 Accumulator[2][512];
 
@@ -314,6 +364,8 @@ void MakeMove(BoardItem* Board, const MoveItem Move)
 
 void UnmakeMove(BoardItem* Board)
 {
+    U64 TraceTime = TRACE_START();
+
     HistoryItem* Info = &Board->MoveTable[--Board->HalfMoveNumber];
 
     Board->CurrentColor ^= 1;
@@ -516,6 +568,10 @@ void UnmakeMove(BoardItem* Board)
 
     Board->Hash = Info->Hash;
 
+    --Board->RepetitionFilter[Board->Hash & (REPETITION_FILTER_SIZE - 1)];
+
+    TRACE_STOP(TRACE_UNMAKE_MOVE, TraceTime);
+
 #ifdef DEBUG_NNUE
     I16 Accumulator[2][512];
 
@@ -567,6 +623,8 @@ void MakeNullMove(BoardItem* Board)
 
     Info->Hash = Board->Hash;
 
+    ++Board->RepetitionFilter[Board->Hash & (REPETITION_FILTER_SIZE - 1)];
+
     if (Info->PassantSquare != -1) {
         Board->PassantSquare = -1;
 
@@ -601,6 +659,8 @@ void UnmakeNullMove(BoardItem* Board)
     Board->FiftyMove = Info->FiftyMove;
 
     Board->Hash = Info->Hash;
+
+    --Board->RepetitionFilter[Board->Hash & (REPETITION_FILTER_SIZE - 1)];
 }
 
 #endif // NULL_MOVE_PRUNING
\ No newline at end of file
@@ -8,6 +8,9 @@
 #include "Board.h"
 #include "Def.h"
 
+int GetMoveType(const BoardItem* Board, const int Move);
+MoveItem CreateMoveItem(const BoardItem* Board, const int Move);
+
 void MakeMove(BoardItem* Board, const MoveItem Move);
 void UnmakeMove(BoardItem* Board);
 
@@ -7,6 +7,8 @@
 #include "BitBoard.h"
 #include "Board.h"
 #include "Def.h"
+#include "Statistic.h"
+#include "Trace.h"
 #include "Types.h"
 #include "Utils.h"
 
@@ -374,9 +376,15 @@ I32 OutputLayer(BoardItem* Board)
 
 int Evaluate(BoardItem* Board)
 {
-#ifdef USE_STATISTIC
-    ++Board->EvaluateCount;
-#endif // USE_STATISTIC
+    U64 TraceTime = TRACE_START();
 
-    return (int)OutputLayer(Board);
+    int Score;
+
+    STAT_INC(Board, STAT_EVALUATE);
+
+    Score = (int)OutputLayer(Board);
+
+    TRACE_STOP(TRACE_EVALUATE, TraceTime);
+
+    return Score;
 }
\ No newline at end of file
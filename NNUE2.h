@@ -18,6 +18,7 @@ void AccumulatorSub(BoardItem* Board, int Square, int PieceWithColor);
 
 void InitAccumulator(BoardItem* Board);
 
+I32 OutputLayer(BoardItem* Board);
 int Evaluate(BoardItem* Board);
 
 #endif // !NNUE2_H
\ No newline at end of file
@@ -0,0 +1,276 @@
+// Perft.cpp
+
+#include "stdafx.h"
+
+#include "Perft.h"
+
+#include "BitBoard.h"
+#include "Board.h"
+#include "Def.h"
+#include "Game.h"
+#include "Gen.h"
+#include "Move.h"
+#include "Types.h"
+#include "Utils.h"
+
+PerftHashStoreItem PerftHashStore = { 0ULL, 0ULL, NULL };
+
+BOOL InitPerftHashTable(const int SizeInMb)
+{
+    U64 Items;
+    U64 RoundItems = 1ULL;
+
+    FreePerftHashTable(); // The hash table may have been initialized earlier
+
+    Items = ((U64)SizeInMb << 20) / sizeof(PerftHashItem);
+
+    while (Items >>= 1) {
+        RoundItems <<= 1;
+    }
+
+    PerftHashStore.Size = RoundItems * sizeof(PerftHashItem);
+    PerftHashStore.Mask = RoundItems - 1;
+
+    PerftHashStore.Item = (PerftHashItem*)calloc(RoundItems, sizeof(PerftHashItem));
+
+    if (PerftHashStore.Item == NULL) { // Allocate memory error
+        printf("Allocate memory to perft hash table error!\n");
+
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+void FreePerftHashTable(void)
+{
+    free(PerftHashStore.Item);
+
+    PerftHashStore.Item = NULL;
+}
+
+BOOL IsLegalMove(const BoardItem* Board, const int Move) // Pseudo-legal move does not leave the king in check
+{
+    int From = MOVE_FROM(Move);
+    int To = MOVE_TO(Move);
+
+    int Color = Board->CurrentColor;
+    int EnemyColor = CHANGE_COLOR(Color);
+
+    int PieceType = PIECE_TYPE(Board->Pieces[From]);
+
+    int KingSquare;
+
+    U64 Occupied = Board->BB_WhitePieces | Board->BB_BlackPieces;
+    U64 Captured = BB_SQUARE(To);
+
+    U64 Attackers;
+
+    if (PieceType == KING) {
+        if (From - To == 2 || To - From == 2) { // Castle (squares are checked by the generator)
+            return TRUE;
+        }
+
+        KingSquare = To;
+
+        Occupied ^= BB_SQUARE(From);
+    }
+    else {
+        KingSquare = LSB(Board->BB_Pieces[Color][KING]);
+
+        if (PieceType == PAWN && To == Board->PassantSquare) { // En passant
+            Captured = BB_SQUARE(Color == WHITE ? To + 8 : To - 8);
+
+            Occupied ^= Captured;
+        }
+
+        Occupied ^= BB_SQUARE(From);
+        Occupied |= BB_SQUARE(To);
+    }
+
+    // Attackers of the king square (captured piece is removed)
+
+    Attackers = PawnAttacks(BB_SQUARE(KingSquare), Color) & Board->BB_Pieces[EnemyColor][PAWN];
+    Attackers |= KnightAttacks(KingSquare) & Board->BB_Pieces[EnemyColor][KNIGHT];
+    Attackers |= BishopAttacks(KingSquare, Occupied) & (Board->BB_Pieces[EnemyColor][BISHOP] | Board->BB_Pieces[EnemyColor][QUEEN]);
+    Attackers |= RookAttacks(KingSquare, Occupied) & (Board->BB_Pieces[EnemyColor][ROOK] | Board->BB_Pieces[EnemyColor][QUEEN]);
+    Attackers |= KingAttacks(KingSquare) & Board->BB_Pieces[EnemyColor][KING];
+
+    return !(Attackers & ~Captured);
+}
+
+U64 PerftHashKey(const BoardItem* Board)
+{
+    return Board->Hash ^ ((U64)Board->CastleFlags * 0x9E3779B97F4A7C15ULL); // Castle flags are not part of the position hash
+}
+
+BOOL LoadPerftHash(const U64 Hash, const int Depth, U64* Nodes)
+{
+    PerftHashItem* HashItemPointer = &PerftHashStore.Item[Hash & PerftHashStore.Mask];
+
+    U64 Value = HashItemPointer->Value; // Load data from record
+
+    if ((HashItemPointer->KeyValue ^ Hash) == Value && (int)(Value & 255) == Depth) {
+        *Nodes = Value >> 8;
+
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+void SavePerftHash(const U64 Hash, const int Depth, const U64 Nodes)
+{
+    PerftHashItem* HashItemPointer = &PerftHashStore.Item[Hash & PerftHashStore.Mask];
+
+    U64 Value = (Nodes << 8) | (U64)Depth;
+
+    // Save record (lockless: a torn record does not pass the key check)
+    HashItemPointer->KeyValue = (Hash ^ Value);
+    HashItemPointer->Value = Value;
+}
+
+U64 Perft(BoardItem* Board, const int Depth)
+{
+    int GenMoveCount;
+    MoveListItem MoveList;
+
+    U64 LegalMoveCount = 0ULL;
+
+    if (Depth == 0) {
+        return 1ULL;
+    }
+
+    if (Depth >= 2 && PerftHashStore.Item != NULL && LoadPerftHash(PerftHashKey(Board), Depth, &LegalMoveCount)) {
+        return LegalMoveCount;
+    }
+
+    GenMoveCount = 0;
+    GenerateAllMoves(Board, NULL, &MoveList, &GenMoveCount);
+
+    if (Depth == 1) { // Bulk counting
+        for (int MoveNumber = 0; MoveNumber < GenMoveCount; ++MoveNumber) {
+            if (IsLegalMove(Board, MoveList.Move[MoveNumber])) {
+                ++LegalMoveCount;
+            }
+        }
+
+        return LegalMoveCount;
+    }
+
+    for (int MoveNumber = 0; MoveNumber < GenMoveCount; ++MoveNumber) {
+        if (!IsLegalMove(Board, MoveList.Move[MoveNumber])) { // Illegal move
+            continue; // Next move
+        }
+
+        MakeMove(Board, CreateMoveItem(Board, MoveList.Move[MoveNumber]));
+
+        LegalMoveCount += Perft(Board, Depth - 1);
+
+        UnmakeMove(Board);
+    }
+
+    if (PerftHashStore.Item != NULL) {
+        SavePerftHash(PerftHashKey(Board), Depth, LegalMoveCount);
+    }
+
+    return LegalMoveCount;
+}
+
+BOOL AddPerftTasks(BoardItem* Board, const int Ply, PerftTaskItem* Task, PerftTaskItem** Tasks, int* TaskCount, int* MaxTaskCount)
+{
+    int GenMoveCount;
+    MoveListItem MoveList;
+
+    PerftTaskItem* NewTasks;
+
+    BOOL Result = TRUE;
+
+    GenMoveCount = 0;
+    GenerateAllMoves(Board, NULL, &MoveList, &GenMoveCount);
+
+    for (int MoveNumber = 0; MoveNumber < GenMoveCount && Result; ++MoveNumber) {
+        if (!IsLegalMove(Board, MoveList.Move[MoveNumber])) { // Illegal move
+            continue; // Next move
+        }
+
+        Task->Move[Ply] = MoveList.Move[MoveNumber];
+
+        if (Ply < PERFT_SPLIT_DEPTH - 1) {
+            MakeMove(Board, CreateMoveItem(Board, MoveList.Move[MoveNumber]));
+
+            Result = AddPerftTasks(Board, Ply + 1, Task, Tasks, TaskCount, MaxTaskCount);
+
+            UnmakeMove(Board);
+
+            continue; // Next move
+        }
+
+        if (*TaskCount >= *MaxTaskCount) {
+            NewTasks = (PerftTaskItem*)realloc(*Tasks, (*MaxTaskCount + 4096) * sizeof(PerftTaskItem));
+
+            if (NewTasks == NULL) { // Allocate memory error
+                printf("Allocate memory to perft tasks error!\n");
+
+                return FALSE;
+            }
+
+            *Tasks = NewTasks;
+            *MaxTaskCount += 4096;
+        }
+
+        (*Tasks)[(*TaskCount)++] = *Task;
+    }
+
+    return Result;
+}
+
+U64 ParallelPerft(BoardItem* Board, const int Depth)
+{
+    PerftTaskItem Task;
+
+    PerftTaskItem* Tasks = NULL;
+
+    int TaskCount = 0;
+    int MaxTaskCount = 0;
+
+    BoardItem* ThreadBoard;
+
+    U64 LegalMoveCount = 0ULL;
+
+    if (Depth <= PERFT_SPLIT_DEPTH) { // Too small to split
+        return Perft(Board, Depth);
+    }
+
+    // Move sequences of PERFT_SPLIT_DEPTH plies are shared between threads
+
+    if (!AddPerftTasks(Board, 0, &Task, &Tasks, &TaskCount, &MaxTaskCount)) {
+        free(Tasks);
+
+        return 0ULL;
+    }
+
+#pragma omp parallel private(ThreadBoard)
+    {
+        ThreadBoard = &ThreadBoardList[omp_get_thread_num()];
+
+        *ThreadBoard = *Board;
+
+#pragma omp for schedule(dynamic, 1) reduction(+ : LegalMoveCount)
+        for (int TaskNumber = 0; TaskNumber < TaskCount; ++TaskNumber) {
+            for (int Ply = 0; Ply < PERFT_SPLIT_DEPTH; ++Ply) {
+                MakeMove(ThreadBoard, CreateMoveItem(ThreadBoard, Tasks[TaskNumber].Move[Ply]));
+            }
+
+            LegalMoveCount += Perft(ThreadBoard, Depth - PERFT_SPLIT_DEPTH);
+
+            for (int Ply = 0; Ply < PERFT_SPLIT_DEPTH; ++Ply) {
+                UnmakeMove(ThreadBoard);
+            }
+        }
+    }
+
+    free(Tasks);
+
+    return LegalMoveCount;
+}
\ No newline at end of file
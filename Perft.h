@@ -0,0 +1,40 @@
+// Perft.h
+
+#pragma once
+
+#ifndef PERFT_H
+#define PERFT_H
+
+#include "Board.h"
+#include "Def.h"
+#include "Types.h"
+
+#define PERFT_HASH_TABLE_SIZE   256 // Mb
+
+#define PERFT_SPLIT_DEPTH       2   // Plies (moves to this depth are shared between threads)
+
+typedef struct {
+    U64 KeyValue;   // Hash ^ Value
+    U64 Value;      // (Nodes << 8) | Depth
+} PerftHashItem; // 16 bytes
+
+typedef struct {
+    int Move[PERFT_SPLIT_DEPTH];
+} PerftTaskItem;
+
+typedef struct {
+    U64 Size;
+    U64 Mask;
+
+    PerftHashItem* Item;
+} PerftHashStoreItem;
+
+BOOL InitPerftHashTable(const int SizeInMb);
+void FreePerftHashTable(void);
+
+BOOL IsLegalMove(const BoardItem* Board, const int Move);
+
+U64 Perft(BoardItem* Board, const int Depth);
+U64 ParallelPerft(BoardItem* Board, const int Depth);
+
+#endif // !PERFT_H
\ No newline at end of file
@@ -0,0 +1,463 @@
+// Pgn.cpp
+
+#include "stdafx.h"
+
+#include "Pgn.h"
+
+#include "Board.h"
+#include "Def.h"
+#include "Gen.h"
+#include "Move.h"
+#include "Types.h"
+#include "Utils.h"
+
+#define STAGE_NONE      1
+#define STAGE_TAG       2
+#define STAGE_NOTATION  3
+#define STAGE_MOVE      4
+#define STAGE_COMMENT   5
+
+BOOL OpenPgnReader(PgnReaderItem* Reader, const char* FileName, const int MaxPly, const int MinElo)
+{
+    fopen_s(&Reader->File, FileName, "rb");
+
+    if (Reader->File == NULL) { // File open error
+        printf("File '%s' open error!\n", FileName);
+
+        return FALSE;
+    }
+
+    Reader->MaxPly = MIN(MaxPly, MAX_PGN_MOVES);
+    Reader->MinElo = MinElo;
+
+    Reader->BufferSize = PGN_CHUNK_SIZE;
+    Reader->DataSize = 0;
+
+    Reader->EndOfFile = FALSE;
+
+    Reader->GameCount = 0;
+    Reader->MaxGameCount = 0;
+
+    Reader->Buffer = (char*)malloc(Reader->BufferSize);
+
+    Reader->Game = NULL;
+    Reader->GameStart = NULL;
+
+    if (Reader->Buffer == NULL) { // Allocate memory error
+        printf("Allocate memory to PGN reader error!\n");
+
+        fclose(Reader->File);
+
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+void ClosePgnReader(PgnReaderItem* Reader)
+{
+    free(Reader->GameStart);
+    free(Reader->Game);
+
+    free(Reader->Buffer);
+
+    fclose(Reader->File);
+}
+
+BOOL AddGameStart(PgnReaderItem* Reader, const int Count, const int Offset)
+{
+    PgnGameItem* NewGame;
+    int* NewGameStart;
+
+    if (Count + 1 >= Reader->MaxGameCount) { // +1 for the end of the last game
+        NewGame = (PgnGameItem*)realloc(Reader->Game, 2 * (Reader->MaxGameCount + 1024) * sizeof(PgnGameItem));
+
+        if (NewGame == NULL) { // Allocate memory error
+            printf("Allocate memory to PGN reader error!\n");
+
+            return FALSE;
+        }
+
+        Reader->Game = NewGame;
+
+        NewGameStart = (int*)realloc(Reader->GameStart, 2 * (Reader->MaxGameCount + 1024) * sizeof(int));
+
+        if (NewGameStart == NULL) { // Allocate memory error
+            printf("Allocate memory to PGN reader error!\n");
+
+            return FALSE;
+        }
+
+        Reader->GameStart = NewGameStart;
+
+        Reader->MaxGameCount = 2 * (Reader->MaxGameCount + 1024);
+    }
+
+    Reader->GameStart[Count] = Offset;
+
+    return TRUE;
+}
+
+int FindGameStarts(PgnReaderItem* Reader)
+{
+    const char* Buffer = Reader->Buffer;
+
+    int Count = 0;
+
+    int Stage = STAGE_NONE;
+
+    int Offset = 0;
+
+    while (Offset < Reader->DataSize) {
+        if (Buffer[Offset] == '\r' || Buffer[Offset] == '\n') { // Empty string
+            if (Stage == STAGE_NOTATION) {
+                Stage = STAGE_NONE;
+            }
+        }
+        else if (Buffer[Offset] == '[') { // Tag
+            if (Stage == STAGE_NONE) { // New game
+                if (!AddGameStart(Reader, Count, Offset)) {
+                    return -1;
+                }
+
+                ++Count;
+
+                Stage = STAGE_TAG;
+            }
+        }
+        else { // Notation
+            if (Stage == STAGE_TAG) {
+                Stage = STAGE_NOTATION;
+            }
+        }
+
+        // Next string (comments may span strings)
+
+        while (Offset < Reader->DataSize && Buffer[Offset] != '\n') {
+            if (Stage != STAGE_NONE && Stage != STAGE_TAG) {
+                if (Buffer[Offset] == '{') { // Comment (open)
+                    Stage = STAGE_COMMENT;
+                }
+                else if (Buffer[Offset] == '}') { // Comment (close)
+                    Stage = STAGE_NOTATION;
+                }
+            }
+
+            ++Offset;
+        }
+
+        ++Offset; // '\n'
+    }
+
+    return Count;
+}
+
+int ResolvePgnMove(BoardItem* Board, const char* MoveString)
+{
+    int Move;
+
+    int GenMoveCount;
+    MoveListItem MoveList;
+
+    char NotateMoveStr[16];
+
+    Move = ParseMove(Board, MoveString);
+
+    if (Move) {
+        MakeMove(Board, CreateMoveItem(Board, Move));
+
+        return Move;
+    }
+
+    // Move not found (print generated moves)
+
+    GenMoveCount = 0;
+    GenerateAllMoves(Board, NULL, &MoveList, &GenMoveCount);
+
+#pragma omp critical
+    {
+        PrintBoard(Board);
+
+        printf("\n");
+
+        printf("Move (%s) not found!\n", MoveString);
+
+        printf("\n");
+
+        printf("Gen. moves:");
+
+        for (int MoveNumber = 0; MoveNumber < GenMoveCount; ++MoveNumber) {
+            NotateMove(Board, CreateMoveItem(Board, MoveList.Move[MoveNumber]), NotateMoveStr);
+
+            printf(" %s%s", BoardName[MOVE_FROM(MoveList.Move[MoveNumber])], BoardName[MOVE_TO(MoveList.Move[MoveNumber])]);
+
+            if (MOVE_PROMOTE_PIECE_TYPE(MoveList.Move[MoveNumber])) {
+                printf("%c", PiecesCharBlack[MOVE_PROMOTE_PIECE_TYPE(MoveList.Move[MoveNumber])]);
+            }
+
+            printf(" (%s)", NotateMoveStr);
+        }
+
+        printf("\n");
+    }
+
+    return 0;
+}
+
+void ParsePgnGame(BoardItem* Board, const PgnReaderItem* Reader, const char* Text, const char* TextEnd, PgnGameItem* Game)
+{
+    int Elo;
+
+    char MoveString[16];
+    char* Move;
+
+    int Stage;
+
+    char Buf[4096];
+    char* Part;
+
+    char* Fen;
+
+    int Length;
+
+    int ResolvedMove;
+
+    // Prepare new game
+
+    Game->Result = 0; // Draw default
+
+    Game->MinElo = INT_MAX;
+
+    Game->Error = FALSE;
+
+    strcpy_s(Game->Fen, MAX_FEN_LENGTH, StartFen);
+
+    Game->MoveCount = 0;
+
+    Move = MoveString;
+    *Move = '\0'; // Nul
+
+    Stage = STAGE_NONE;
+
+    while (Text < TextEnd) {
+        // Copy string (as fgets)
+
+        for (Length = 0; Text + Length < TextEnd && Length < (int)sizeof(Buf) - 1; ++Length) {
+            if (Text[Length] == '\n') {
+                ++Length;
+
+                break; // for
+            }
+        }
+
+        memcpy(Buf, Text, Length);
+        Buf[Length] = '\0'; // Nul
+
+        Text += Length;
+
+        Part = Buf;
+
+        if (*Part == '\r' || *Part == '\n') { // Empty string
+            if (Stage == STAGE_NOTATION) {
+                break; // while (end of game)
+            }
+
+            continue; // Next string
+        }
+
+        if (*Part == '[') { // Tag
+            if (Stage == STAGE_NONE) {
+                Stage = STAGE_TAG;
+            }
+
+            if (strncmp(Part, "[Result \"1-0\"]", 14) == 0) { // Result 1-0
+                Game->Result = 1; // White win
+            }
+            else if (strncmp(Part, "[Result \"1/2-1/2\"]", 18) == 0) { // Result 1/2-1/2
+                Game->Result = 0; // Draw
+            }
+            else if (strncmp(Part, "[Result \"0-1\"]", 14) == 0) { // Result 0-1
+                Game->Result = -1; // Black win
+            }
+            else if (strncmp(Part, "[FEN \"", 6) == 0) { // FEN
+                Part += 6;
+
+                Fen = Game->Fen;
+
+                while (*Part != '"' && *Part != '\0' && Fen < Game->Fen + MAX_FEN_LENGTH - 1) {
+                    *Fen++ = *Part++; // Copy FEN
+                }
+
+                *Fen = '\0'; // Nul
+            }
+            else if (strncmp(Part, "[WhiteElo \"", 11) == 0) { // WhiteElo
+                Part += 11;
+
+                Elo = atoi(Part);
+
+                Game->MinElo = MIN(Game->MinElo, Elo);
+            }
+            else if (strncmp(Part, "[BlackElo \"", 11) == 0) { // BlackElo
+                Part += 11;
+
+                Elo = atoi(Part);
+
+                Game->MinElo = MIN(Game->MinElo, Elo);
+            }
+
+            continue; // Next string
+        } // if
+
+        if (Stage == STAGE_TAG) {
+            SetFen(Board, Game->Fen); // First position in game (StartFen or FEN from FEN-tag)
+
+            Stage = STAGE_NOTATION;
+        }
+
+        if (Game->Error || Game->MoveCount >= Reader->MaxPly || Game->MinElo < Reader->MinElo) {
+            continue; // Next string
+        }
+
+        while (*Part != '\0') { // Scan string
+            if (*Part == '{') { // Comment (open)
+                Stage = STAGE_COMMENT;
+            }
+            else if (*Part == '}') { // Comment (close)
+                Stage = STAGE_NOTATION;
+            }
+
+            if (Stage == STAGE_NOTATION) {
+                if (strchr(MoveFirstChar, *Part) != NULL) {
+                    Stage = STAGE_MOVE;
+
+                    Move = MoveString;
+
+                    *Move++ = *Part; // Copy move (first char)
+                }
+            }
+            else if (Stage == STAGE_MOVE) {
+                if (strchr(MoveSubsequentChar, *Part) != NULL) {
+                    if (Move < MoveString + sizeof(MoveString) - 1) {
+                        *Move++ = *Part; // Copy move (subsequent char)
+                    }
+                }
+                else { // End of move
+                    *Move = '\0'; // Nul
+
+                    Stage = STAGE_NOTATION;
+
+                    if (Game->Error || Game->MoveCount >= Reader->MaxPly) {
+                        ++Part;
+
+                        continue; // Next character in string
+                    }
+
+                    ResolvedMove = ResolvePgnMove(Board, MoveString);
+
+                    if (ResolvedMove) {
+                        Game->Move[Game->MoveCount++] = (U16)ResolvedMove;
+                    }
+                    else { // Move not found
+                        Game->Error = TRUE;
+                    }
+                }
+            }
+
+            ++Part;
+        } // while
+    } // while
+}
+
+BOOL ReadPgnGames(PgnReaderItem* Reader)
+{
+    int ReadSize;
+
+    int Count;
+    int SplitPoint;
+
+    char* NewBuffer;
+
+    Reader->GameCount = 0;
+
+    while (TRUE) {
+        // Read next chunk
+
+        if (!Reader->EndOfFile && Reader->DataSize < Reader->BufferSize) {
+            ReadSize = (int)fread(Reader->Buffer + Reader->DataSize, 1, Reader->BufferSize - Reader->DataSize, Reader->File);
+
+            Reader->DataSize += ReadSize;
+
+            if (ReadSize < Reader->BufferSize - Reader->DataSize + ReadSize) { // End of file (or read error)
+                Reader->EndOfFile = TRUE;
+            }
+        }
+
+        if (Reader->DataSize == 0) { // No more games
+            return FALSE;
+        }
+
+        Count = FindGameStarts(Reader);
+
+        if (Count < 0) { // Allocate memory error
+            return FALSE;
+        }
+
+        if (Reader->EndOfFile) { // All games are complete
+            Reader->GameCount = Count;
+
+            SplitPoint = Reader->DataSize;
+
+            break; // while
+        }
+
+        if (Count >= 2) { // The last game may be incomplete
+            Reader->GameCount = Count - 1;
+
+            SplitPoint = Reader->GameStart[Count - 1];
+
+            break; // while
+        }
+
+        // The game is longer than the buffer
+
+        if (Reader->BufferSize >= PGN_MAX_CHUNK_SIZE) { // Malformed input
+            printf("Read PGN file error (no complete game in %d bytes)!\n", Reader->BufferSize);
+
+            return FALSE;
+        }
+
+        NewBuffer = (char*)realloc(Reader->Buffer, 2 * Reader->BufferSize);
+
+        if (NewBuffer == NULL) { // Allocate memory error
+            printf("Allocate memory to PGN reader error!\n");
+
+            return FALSE;
+        }
+
+        Reader->Buffer = NewBuffer;
+        Reader->BufferSize *= 2;
+    } // while
+
+    if (Reader->GameCount == 0) { // No games (end of file)
+        Reader->DataSize = 0;
+
+        return FALSE;
+    }
+
+    Reader->GameStart[Reader->GameCount] = SplitPoint; // End of the last game
+
+    // Parse games in parallel (each thread uses own board)
+
+#pragma omp parallel for schedule(dynamic, 16)
+    for (int GameNumber = 0; GameNumber < Reader->GameCount; ++GameNumber) {
+        ParsePgnGame(&ThreadBoardList[omp_get_thread_num()], Reader, Reader->Buffer + Reader->GameStart[GameNumber], Reader->Buffer + Reader->GameStart[GameNumber + 1], &Reader->Game[GameNumber]);
+    }
+
+    // Keep the incomplete game for the next chunk
+
+    memmove(Reader->Buffer, Reader->Buffer + SplitPoint, Reader->DataSize - SplitPoint);
+
+    Reader->DataSize -= SplitPoint;
+
+    return TRUE;
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+// Pgn.h
+
+#pragma once
+
+#ifndef PGN_H
+#define PGN_H
+
+#include "Board.h"
+#include "Def.h"
+#include "Types.h"
+
+#define PGN_CHUNK_SIZE      (4 * 1024 * 1024) // Bytes (initial; grows for a longer game)
+#define PGN_MAX_CHUNK_SIZE  (64 * 1024 * 1024) // Bytes (a longer game or no tag in the chunk is malformed input)
+
+#define MAX_PGN_MOVES       1024 // Plies
+
+typedef struct {
+    int Result; // 1 = white win, 0 = draw, -1 = black win
+
+    int MinElo;
+
+    BOOL Error; // Move not found (moves before the error are valid)
+
+    char Fen[MAX_FEN_LENGTH]; // Start position
+
+    int MoveCount;
+    U16 Move[MAX_PGN_MOVES];
+} PgnGameItem;
+
+typedef struct {
+    FILE* File;
+
+    int MaxPly;
+    int MinElo; // Moves are not parsed for games with a lower Elo
+
+    char* Buffer;
+    int BufferSize;
+    int DataSize;
+
+    BOOL EndOfFile;
+
+    int GameCount;
+    int MaxGameCount;
+
+    PgnGameItem* Game;
+    int* GameStart; // [GameCount + 1] offsets in buffer
+} PgnReaderItem;
+
+BOOL OpenPgnReader(PgnReaderItem* Reader, const char* FileName, const int MaxPly, const int MinElo);
+BOOL ReadPgnGames(PgnReaderItem* Reader);
+void ClosePgnReader(PgnReaderItem* Reader);
+
+#endif // !PGN_H
\ No newline at end of file
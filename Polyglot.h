@@ -0,0 +1,45 @@
+// Polyglot.h
+
+#pragma once
+
+#ifndef POLYGLOT_H
+#define POLYGLOT_H
+
+#include "Board.h"
+#include "Book.h"
+#include "Def.h"
+#include "Types.h"
+
+#define POLYGLOT_RANDOM_COUNT   781 // 768 pieces + 4 castle + 8 en passant + 1 turn
+
+#define POLYGLOT_MAX_WEIGHT     65535
+
+typedef struct {
+    U64 Key;
+
+    U16 Move;
+    U16 Weight;
+
+    U32 Learn;
+} PolyglotItem; // 16 bytes (big-endian in file, sorted by key)
+
+typedef struct {
+    int Count;
+
+    const PolyglotItem* Item;
+
+    HANDLE FileHandle;
+    HANDLE MappingHandle;
+} PolyglotStoreItem;
+
+U64 PolyglotKey(const BoardItem* Board);
+int PolyglotMove(const MoveItem Move);
+
+BOOL SavePolyglotBook(const char* BookFileName, const BookListItem* BookList);
+
+void LoadPolyglotBook(const char* BookFileName);
+void FreePolyglotBook(void);
+
+BOOL GetPolyglotBookMove(const BoardItem* Board, const U64 RandomValue, MoveItem* BestMoves);
+
+#endif // !POLYGLOT_H
\ No newline at end of file
@@ -13,6 +13,7 @@
 #include "NNUE2.h"
 #include "SEE.h"
 #include "Sort.h"
+#include "Statistic.h"
 #include "Types.h"
 #include "Utils.h"
 
@@ -25,7 +26,9 @@ int QuiescenceSearch(BoardItem* Board, int Alpha, int Beta, const int Depth, con
     assert(InCheck == IsInCheck(Board, Board->CurrentColor));
 
     int GenMoveCount;
-    MoveItem MoveList[MAX_GEN_MOVES];
+    MoveListItem MoveList;
+
+    MoveItem CurrentMove;
 
 #ifdef QUIESCENCE_USE_CHECK
     int LegalMoveCount = 0;
@@ -49,15 +52,14 @@ int QuiescenceSearch(BoardItem* Board, int Alpha, int Beta, const int Depth, con
 
     BOOL GiveCheck;
 
-#ifdef USE_STATISTIC
-    ++Board->QuiescenceCount;
-#endif // USE_STATISTIC
+#ifdef QUIESCENCE_SEE_MOVE_PRUNING
+    PinnedItem Pinned = { FALSE, { 0ULL, 0ULL }, { 0ULL, 0ULL } }; // Computed by the first SEE_GE()
+#endif // QUIESCENCE_SEE_MOVE_PRUNING
 
     if (omp_get_thread_num() == 0) { // Master thread
         if (
-            CompletedDepth >= MIN_SEARCH_DEPTH
-            && (Board->Nodes & 4095) == 0
-            && Clock() >= TimeStop
+            (CompletedDepth >= MIN_SEARCH_DEPTH && (Board->Nodes & 4095) == 0 && Clock() >= TimeStop)
+            || (MaxNodes > 0ULL && CompletedDepth >= 1 && IsNodeLimitReached(Board))
         ) {
             StopSearch = TRUE;
 
@@ -65,10 +67,19 @@ int QuiescenceSearch(BoardItem* Board, int Alpha, int Beta, const int Depth, con
         }
     }
 
-    if (StopSearch) {
+    if (
+        (Board->NodeLimit > 0ULL && Board->Nodes >= Board->NodeLimit)
+        || (Board->TimeLimit > 0ULL && (Board->Nodes & 4095) == 0 && Clock() >= Board->TimeLimit)
+    ) { // Own node or time limit (one search per thread)
+        Board->LimitReached = TRUE;
+    }
+
+    if (StopSearch || Board->LimitReached) {
         return 0;
     }
 
+    STAT_INC(Board, STAT_QUIESCENCE);
+
     if (IsInsufficientMaterial(Board)) {
         return 0;
     }
@@ -104,7 +115,9 @@ int QuiescenceSearch(BoardItem* Board, int Alpha, int Beta, const int Depth, con
         return Evaluate(Board);
     }
 
-    LoadHash(Board->Hash, &HashDepth, Ply, &HashScore, &HashStaticScore, &HashMove, &HashFlag);
+    LoadHash(Board->HashStore, Board->Hash, &HashDepth, Ply, &HashScore, &HashStaticScore, &HashMove, &HashFlag);
+
+    STAT_INC(Board, STAT_QUIESCENCE_HASH_PROBE);
 
     if (InCheck || Depth >= 0) {
         QuiescenceHashDepth = 0;
@@ -114,9 +127,7 @@ int QuiescenceSearch(BoardItem* Board, int Alpha, int Beta, const int Depth, con
     }
 
     if (HashFlag) {
-#ifdef USE_STATISTIC
-        ++Board->HashCount;
-#endif // USE_STATISTIC
+        STAT_INC(Board, STAT_QUIESCENCE_HASH_HIT);
 
         if (!IsPrincipal && HashDepth >= QuiescenceHashDepth) {
             if (
@@ -124,6 +135,8 @@ int QuiescenceSearch(BoardItem* Board, int Alpha, int Beta, const int Depth, con
                 || (HashFlag == HASH_ALPHA && HashScore <= Alpha)
                 || HashFlag == HASH_EXACT
             ) {
+                STAT_INC(Board, STAT_QUIESCENCE_HASH_CUTOFF);
+
                 return HashScore;
             }
         }
@@ -134,7 +147,7 @@ int QuiescenceSearch(BoardItem* Board, int Alpha, int Beta, const int Depth, con
         BestScore = StaticScore = -INF + Ply;
 
         GenMoveCount = 0;
-        GenerateAllMoves(Board, NULL, MoveList, &GenMoveCount);
+        GenerateAllMoves(Board, NULL, &MoveList, &GenMoveCount);
     }
     else {
 #endif // QUIESCENCE_USE_CHECK
@@ -155,9 +168,11 @@ int QuiescenceSearch(BoardItem* Board, int Alpha, int Beta, const int Depth, con
 
         if (BestScore >= Beta) {
             if (!HashFlag) {
-                SaveHash(Board->Hash, -MAX_PLY, 0, 0, StaticScore, 0, HASH_STATIC_SCORE);
+                SaveHash(Board->HashStore, Board->Hash, -MAX_PLY, 0, 0, StaticScore, 0, HASH_STATIC_SCORE);
             }
 
+            STAT_INC(Board, STAT_QUIESCENCE_STAND_PAT);
+
             return BestScore;
         }
 
@@ -166,28 +181,32 @@ int QuiescenceSearch(BoardItem* Board, int Alpha, int Beta, const int Depth, con
         }
 
         GenMoveCount = 0;
-        GenerateCaptureMoves(Board, NULL, MoveList, &GenMoveCount);
+        GenerateCaptureMoves(Board, NULL, &MoveList, &GenMoveCount);
 #ifdef QUIESCENCE_USE_CHECK
     }
 #endif // QUIESCENCE_USE_CHECK
 
-    SetHashMoveSortValue(MoveList, GenMoveCount, HashMove);
+    SetHashMoveSortValue(&MoveList, GenMoveCount, HashMove);
 
     for (int MoveNumber = 0; MoveNumber < GenMoveCount; ++MoveNumber) {
-        PrepareNextMove(MoveNumber, MoveList, GenMoveCount);
+        PrepareNextMove(MoveNumber, &MoveList, GenMoveCount);
+
+        CurrentMove = CreateMoveItem(Board, MoveList.Move[MoveNumber]);
 
 #ifdef QUIESCENCE_SEE_MOVE_PRUNING
-        if (!InCheck && MoveList[MoveNumber].Move != HashMove) {
-            if (SEE(Board, MoveList[MoveNumber].Type, MoveList[MoveNumber].Move) < 0) { // Bad capture/quiet move
+        if (!InCheck && CurrentMove.Move != HashMove) {
+            if (!SEE_GE(Board, CurrentMove.Type, CurrentMove.Move, 0, &Pinned)) { // Bad capture/quiet move
+                STAT_INC(Board, STAT_QUIESCENCE_SEE_PRUNING);
+
                 continue; // Next move
             }
         }
 #endif // QUIESCENCE_SEE_MOVE_PRUNING
 
-        MakeMove(Board, MoveList[MoveNumber]);
+        MakeMove(Board, CurrentMove);
 
 #ifdef HASH_PREFETCH
-        Prefetch(Board->Hash);
+        Prefetch(Board->HashStore, Board->Hash);
 #endif // HASH_PREFETCH
 
         if (IsInCheck(Board, CHANGE_COLOR(Board->CurrentColor))) { // Illegal move
@@ -208,7 +227,7 @@ int QuiescenceSearch(BoardItem* Board, int Alpha, int Beta, const int Depth, con
 
         UnmakeMove(Board);
 
-        if (StopSearch) {
+        if (StopSearch || Board->LimitReached) {
             return 0;
         }
 
@@ -216,17 +235,15 @@ int QuiescenceSearch(BoardItem* Board, int Alpha, int Beta, const int Depth, con
             BestScore = Score;
 
             if (BestScore > Alpha) {
-                BestMove = MoveList[MoveNumber];
+                BestMove = CurrentMove;
 
                 if (IsPrincipal && BestScore < Beta) {
                     Alpha = BestScore;
                 }
                 else { // !IsPrincipal || BestScore >= Beta
-#ifdef USE_STATISTIC
-                    ++Board->CutoffCount;
-#endif // USE_STATISTIC
+                    STAT_INC(Board, STAT_QUIESCENCE_CUTOFF);
 
-                    SaveHash(Board->Hash, QuiescenceHashDepth, Ply, BestScore, StaticScore, BestMove.Move, HASH_BETA);
+                    SaveHash(Board->HashStore, Board->Hash, QuiescenceHashDepth, Ply, BestScore, StaticScore, BestMove.Move, HASH_BETA);
 
                     return BestScore;
                 }
@@ -247,7 +264,7 @@ int QuiescenceSearch(BoardItem* Board, int Alpha, int Beta, const int Depth, con
         HashFlag = HASH_ALPHA;
     }
 
-    SaveHash(Board->Hash, QuiescenceHashDepth, Ply, BestScore, StaticScore, BestMove.Move, HashFlag);
+    SaveHash(Board->HashStore, Board->Hash, QuiescenceHashDepth, Ply, BestScore, StaticScore, BestMove.Move, HashFlag);
 
     return BestScore;
 }
\ No newline at end of file
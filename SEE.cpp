@@ -7,6 +7,7 @@
 #include "BitBoard.h"
 #include "Board.h"
 #include "Def.h"
+#include "Trace.h"
 #include "Types.h"
 #include "Utils.h"
 
@@ -37,6 +38,195 @@ U64 AttackTo(const BoardItem* Board, const int Square, const U64 Occupied)
     return Attackers;
 }
 
+U64 PinnedPieces(const BoardItem* Board, const int Color, U64* Pinners)
+{
+    int KingSquare = LSB(Board->BB_Pieces[Color][KING]);
+    int Square;
+
+    U64 Occupied = Board->BB_WhitePieces | Board->BB_BlackPieces;
+    U64 OwnPieces = (Color == WHITE) ? Board->BB_WhitePieces : Board->BB_BlackPieces;
+
+    U64 Snipers;
+    U64 Between;
+
+    U64 Pinned = 0ULL;
+
+    Snipers = RookAttacks(KingSquare, 0ULL) & (Board->BB_Pieces[CHANGE_COLOR(Color)][ROOK] | Board->BB_Pieces[CHANGE_COLOR(Color)][QUEEN]);
+    Snipers |= BishopAttacks(KingSquare, 0ULL) & (Board->BB_Pieces[CHANGE_COLOR(Color)][BISHOP] | Board->BB_Pieces[CHANGE_COLOR(Color)][QUEEN]);
+
+    *Pinners = 0ULL;
+
+    while (Snipers) {
+        Square = LSB(Snipers);
+
+        if (RookAttacks(KingSquare, 0ULL) & BB_SQUARE(Square)) {
+            Between = RookAttacks(KingSquare, BB_SQUARE(Square)) & RookAttacks(Square, BB_SQUARE(KingSquare));
+        }
+        else {
+            Between = BishopAttacks(KingSquare, BB_SQUARE(Square)) & BishopAttacks(Square, BB_SQUARE(KingSquare));
+        }
+
+        Between &= Occupied;
+
+        if (Between && !(Between & (Between - 1)) && (Between & OwnPieces)) { // One own piece between the king and the sniper
+            Pinned |= Between;
+            *Pinners |= BB_SQUARE(Square);
+        }
+
+        Snipers &= Snipers - 1;
+    }
+
+    return Pinned;
+}
+
+BOOL SEE_GE(const BoardItem* Board, const int MoveType, const int Move, const int Threshold, PinnedItem* Pinned) // Stockfish
+{
+    int From = MOVE_FROM(Move);
+    int To = MOVE_TO(Move);
+
+    int PieceType;
+
+    int Swap;
+
+    int Color = Board->CurrentColor;
+
+    BOOL Result = TRUE;
+
+    U64 Occupied = Board->BB_WhitePieces | Board->BB_BlackPieces;
+
+    U64 Attackers;
+    U64 CurrentAttackers;
+    U64 Bits;
+
+    U64 BishopsOrQueens = Board->BB_Pieces[WHITE][BISHOP] | Board->BB_Pieces[WHITE][QUEEN] | Board->BB_Pieces[BLACK][BISHOP] | Board->BB_Pieces[BLACK][QUEEN];
+    U64 RooksOrQueens = Board->BB_Pieces[WHITE][ROOK] | Board->BB_Pieces[WHITE][QUEEN] | Board->BB_Pieces[BLACK][ROOK] | Board->BB_Pieces[BLACK][QUEEN];
+
+    PinnedItem LocalPinned;
+
+    U64 TraceTime;
+
+    if (MoveType & MOVE_PAWN_PASSANT) {
+        Swap = PiecesScoreSEE[PAWN];
+
+        if (Color == WHITE) {
+            Occupied &= ~BB_SQUARE(To + 8);
+        }
+        else { // BLACK
+            Occupied &= ~BB_SQUARE(To - 8);
+        }
+    }
+    else if (MoveType & MOVE_CAPTURE) {
+        Swap = PiecesScoreSEE[PIECE_TYPE(Board->Pieces[To])];
+    }
+    else {
+        Swap = 0;
+    }
+
+    if (MoveType & MOVE_PAWN_PROMOTE) {
+        PieceType = MOVE_PROMOTE_PIECE_TYPE(Move);
+
+        Swap += PiecesScoreSEE[PieceType] - PiecesScoreSEE[PAWN];
+    }
+    else {
+        PieceType = PIECE_TYPE(Board->Pieces[From]);
+    }
+
+    Swap -= Threshold;
+
+    if (Swap < 0) { // The capture alone does not reach the threshold
+        return FALSE;
+    }
+
+    Swap = PiecesScoreSEE[PieceType] - Swap;
+
+    if (Swap <= 0) { // Losing the moved piece still reaches the threshold
+        return TRUE;
+    }
+
+    TraceTime = TRACE_START(); // Exchange only
+
+    Occupied ^= BB_SQUARE(From) | BB_SQUARE(To); // The moved piece on the square (a captured pinner does not pin any more)
+
+    Attackers = AttackTo(Board, To, Occupied) & Occupied;
+
+    if (!Pinned) { // Not cached by the caller
+        Pinned = &LocalPinned;
+
+        Pinned->Ready = FALSE;
+    }
+
+    if (!Pinned->Ready) { // Once per position
+        Pinned->Pinned[WHITE] = PinnedPieces(Board, WHITE, &Pinned->Pinners[WHITE]);
+        Pinned->Pinned[BLACK] = PinnedPieces(Board, BLACK, &Pinned->Pinners[BLACK]);
+
+        Pinned->Ready = TRUE;
+    }
+
+    while (TRUE) {
+        Color ^= 1;
+
+        Attackers &= Occupied;
+
+        if (Color == WHITE) {
+            CurrentAttackers = Attackers & Board->BB_WhitePieces;
+        }
+        else { // BLACK
+            CurrentAttackers = Attackers & Board->BB_BlackPieces;
+        }
+
+        if (Pinned->Pinners[Color] & Occupied) { // Pinned pieces can not capture while the pinner is on the board
+            CurrentAttackers &= ~Pinned->Pinned[Color];
+        }
+
+        if (!CurrentAttackers) {
+            break; // while
+        }
+
+        Result ^= 1;
+
+        for (PieceType = 0; PieceType < 6; ++PieceType) { // PNBRQK
+            Bits = CurrentAttackers & Board->BB_Pieces[Color][PieceType];
+
+            if (Bits) {
+                break; // for
+            }
+        }
+
+        if (PieceType == KING) { // The king can capture only if the square is not defended
+            if (Color == WHITE) {
+                Result = ((Attackers & Board->BB_BlackPieces) ? Result ^ 1 : Result);
+            }
+            else { // BLACK
+                Result = ((Attackers & Board->BB_WhitePieces) ? Result ^ 1 : Result);
+            }
+
+            break; // while
+        }
+
+        Swap = PiecesScoreSEE[PieceType] - Swap;
+
+        if (Swap < Result) {
+            break; // while
+        }
+
+        Occupied &= ~BB_SQUARE(LSB(Bits));
+
+        // Add X-ray attacks behind the capturing piece (only along its line to the square)
+        if (PieceType == PAWN || PieceType == BISHOP || PieceType == QUEEN) {
+            Attackers |= BishopAttacks(To, Occupied) & BishopsOrQueens;
+        }
+
+        if (PieceType == ROOK || PieceType == QUEEN) {
+            Attackers |= RookAttacks(To, Occupied) & RooksOrQueens;
+        }
+    } // while
+
+    TRACE_STOP(TRACE_SEE, TraceTime);
+
+    return Result;
+}
+
+#ifdef BAD_CAPTURE_LAST
 int SEE(const BoardItem* Board, const int MoveType, const int Move)
 {
     int Gain[32];
@@ -60,6 +250,8 @@ int SEE(const BoardItem* Board, const int MoveType, const int Move)
 
     int Depth = 1;
 
+    U64 TraceTime = TRACE_START();
+
 #ifdef DEBUG_SEE
     printf("-- SEE: Move = %s%s\n", BoardName[From], BoardName[To]);
 #endif // DEBUG_SEE
@@ -153,7 +345,10 @@ int SEE(const BoardItem* Board, const int MoveType, const int Move)
 #endif // DEBUG_SEE
     }
 
+    TRACE_STOP(TRACE_SEE, TraceTime);
+
     return Gain[0];
 }
+#endif // BAD_CAPTURE_LAST
 
 #endif // PROBCUT || BAD_CAPTURE_LAST || SEE_CAPTURE_MOVE_PRUNING || SEE_QUIET_MOVE_PRUNING || QUIESCENCE_SEE_MOVE_PRUNING
\ No newline at end of file
@@ -9,7 +9,18 @@
 #include "Def.h"
 
 #if defined(PROBCUT) || defined(BAD_CAPTURE_LAST) || defined(SEE_CAPTURE_MOVE_PRUNING) || defined(SEE_QUIET_MOVE_PRUNING) || defined(QUIESCENCE_SEE_MOVE_PRUNING)
+typedef struct {
+    BOOL Ready; // Computed by the first SEE_GE() of the node
+
+    U64 Pinned[2];
+    U64 Pinners[2];
+} PinnedItem;
+
+BOOL SEE_GE(const BoardItem* Board, const int MoveType, const int Move, const int Threshold, PinnedItem* Pinned);
+
+#ifdef BAD_CAPTURE_LAST
 int SEE(const BoardItem* Board, const int MoveType, const int Move);
+#endif // BAD_CAPTURE_LAST
 #endif // PROBCUT || BAD_CAPTURE_LAST || SEE_CAPTURE_MOVE_PRUNING || SEE_QUIET_MOVE_PRUNING || QUIESCENCE_SEE_MOVE_PRUNING
 
 #endif // !SEE_H
\ No newline at end of file
@@ -15,6 +15,8 @@
 #include "QuiescenceSearch.h"
 #include "SEE.h"
 #include "Sort.h"
+#include "Statistic.h"
+#include "Trace.h"
 #include "Types.h"
 #include "Utils.h"
 
@@ -48,13 +50,17 @@ int Search(BoardItem* Board, int Alpha, int Beta, int Depth, const int Ply, Move
     assert(InCheck == IsInCheck(Board, Board->CurrentColor));
 
     int GenMoveCount;
-    MoveItem MoveList[MAX_GEN_MOVES];
+    MoveListItem MoveList;
+
+    MoveItem CurrentMove;
 
     int QuietMoveCount = 0;
     int QuietMoveList[MAX_GEN_MOVES]; // Move only
 
     int LegalMoveCount = 0;
 
+    U64 RootMoveNodes = 0ULL;
+
     MoveItem BestMove = (MoveItem){ 0, 0, 0 };
 
     MoveItem TempBestMoves[MAX_PLY];
@@ -95,6 +101,18 @@ int Search(BoardItem* Board, int Alpha, int Beta, int Depth, const int Ply, Move
     int SEE_Value;
 #endif // BAD_CAPTURE_LAST
 
+#if defined(SEE_CAPTURE_MOVE_PRUNING) && !defined(BAD_CAPTURE_LAST)
+    BOOL BadCaptureMove;
+#endif // SEE_CAPTURE_MOVE_PRUNING && !BAD_CAPTURE_LAST
+
+#ifdef SEE_QUIET_MOVE_PRUNING
+    BOOL BadQuietMove;
+#endif // SEE_QUIET_MOVE_PRUNING
+
+#if defined(PROBCUT) || defined(SEE_CAPTURE_MOVE_PRUNING) || defined(SEE_QUIET_MOVE_PRUNING)
+    PinnedItem Pinned = { FALSE, { 0ULL, 0ULL }, { 0ULL, 0ULL } }; // Computed by the first SEE_GE()
+#endif // PROBCUT || SEE_CAPTURE_MOVE_PRUNING || SEE_QUIET_MOVE_PRUNING
+
 #ifdef LATE_MOVE_REDUCTION
     int LateMoveReduction;
 #endif // LATE_MOVE_REDUCTION
@@ -103,18 +121,31 @@ int Search(BoardItem* Board, int Alpha, int Beta, int Depth, const int Ply, Move
     int SingularBeta;
 #endif // SINGULAR_EXTENSION
 
+#ifdef QUIET_MOVE_PARTIAL_SORT
+    BOOL QuietMovesSorted = FALSE;
+#endif // QUIET_MOVE_PARTIAL_SORT
+
     int* CMH_Pointer[2];
 
+    U64 TraceTime;
+
     if (Depth <= 0) {
-        return QuiescenceSearch(Board, Alpha, Beta, 0, Ply, IsPrincipal, InCheck);
+        TraceTime = TRACE_START();
+
+        Score = QuiescenceSearch(Board, Alpha, Beta, 0, Ply, IsPrincipal, InCheck);
+
+        TRACE_STOP(TRACE_QUIESCENCE, TraceTime);
+
+        return Score;
     }
 
     if (omp_get_thread_num() == 0) { // Master thread
         if (
             Ply > 0
-            && CompletedDepth >= MIN_SEARCH_DEPTH
-            && (Board->Nodes & 4095) == 0
-            && Clock() >= TimeStop
+            && (
+                (CompletedDepth >= MIN_SEARCH_DEPTH && (Board->Nodes & 4095) == 0 && Clock() >= TimeStop)
+                || (MaxNodes > 0ULL && CompletedDepth >= 1 && IsNodeLimitReached(Board))
+            )
         ) {
             StopSearch = TRUE;
 
@@ -122,10 +153,19 @@ int Search(BoardItem* Board, int Alpha, int Beta, int Depth, const int Ply, Move
         }
     }
 
-    if (StopSearch) {
+    if (
+        (Board->NodeLimit > 0ULL && Board->Nodes >= Board->NodeLimit)
+        || (Board->TimeLimit > 0ULL && (Board->Nodes & 4095) == 0 && Clock() >= Board->TimeLimit)
+    ) { // Own node or time limit (one search per thread)
+        Board->LimitReached = TRUE;
+    }
+
+    if (StopSearch || Board->LimitReached) {
         return 0;
     }
 
+    STAT_INC(Board, STAT_SEARCH);
+
     if (Ply > 0) {
         if (IsInsufficientMaterial(Board)) {
             return 0;
@@ -145,6 +185,16 @@ int Search(BoardItem* Board, int Alpha, int Beta, int Depth, const int Ply, Move
             return 0;
         }
 
+#ifdef UPCOMING_REPETITION
+        if (Alpha < 0 && UpcomingRepetition(Board, Ply)) { // Stockfish
+            Alpha = 0;
+
+            if (Alpha >= Beta) {
+                return Alpha;
+            }
+        }
+#endif // UPCOMING_REPETITION
+
 #ifdef MATE_DISTANCE_PRUNING
         Alpha = MAX(Alpha, -INF + Ply);
         Beta = MIN(Beta, INF - Ply - 1);
@@ -175,12 +225,12 @@ int Search(BoardItem* Board, int Alpha, int Beta, int Depth, const int Ply, Move
 #endif // COUNTER_MOVE_HISTORY
 
     if (!SkipMove) {
-        LoadHash(Board->Hash, &HashDepth, Ply, &HashScore, &HashStaticScore, &HashMove, &HashFlag);
+        LoadHash(Board->HashStore, Board->Hash, &HashDepth, Ply, &HashScore, &HashStaticScore, &HashMove, &HashFlag);
+
+        STAT_INC(Board, STAT_HASH_PROBE);
 
         if (HashFlag) {
-#ifdef USE_STATISTIC
-            ++Board->HashCount;
-#endif // USE_STATISTIC
+            STAT_INC(Board, STAT_HASH_HIT);
 
             if (!IsPrincipal && HashDepth >= Depth) {
                 if (
@@ -217,6 +267,8 @@ int Search(BoardItem* Board, int Alpha, int Beta, int Depth, const int Ply, Move
                         }
                     }
 
+                    STAT_INC(Board, STAT_HASH_CUTOFF);
+
                     return HashScore;
                 } // if
             } // if
@@ -234,7 +286,7 @@ int Search(BoardItem* Board, int Alpha, int Beta, int Depth, const int Ply, Move
             StaticScore = Evaluate(Board);
 
             if (!SkipMove) {
-                SaveHash(Board->Hash, -MAX_PLY, 0, 0, StaticScore, 0, HASH_STATIC_SCORE);
+                SaveHash(Board->HashStore, Board->Hash, -MAX_PLY, 0, 0, StaticScore, 0, HASH_STATIC_SCORE);
             }
         }
     }
@@ -243,6 +295,8 @@ int Search(BoardItem* Board, int Alpha, int Beta, int Depth, const int Ply, Move
     if (UsePruning && !IsPrincipal && !InCheck) {
 #ifdef REVERSE_FUTILITY_PRUNING
         if (NonPawnMaterial && Depth <= 5 && (StaticScore - ReverseFutilityMargin(Depth)) >= Beta) { // Hakkapeliitta
+            STAT_INC(Board, STAT_REVERSE_FUTILITY_PRUNING);
+
             return (StaticScore - ReverseFutilityMargin(Depth));
         }
 #endif // REVERSE_FUTILITY_PRUNING
@@ -251,14 +305,18 @@ int Search(BoardItem* Board, int Alpha, int Beta, int Depth, const int Ply, Move
         if (Depth <= 3 && (StaticScore + RazoringMargin(Depth)) <= Alpha) { // Hakkapeliitta
             RazoringAlpha = Alpha - RazoringMargin(Depth);
 
+            STAT_INC(Board, STAT_RAZORING_TRY);
+
             // Zero window quiescence search
             Score = QuiescenceSearch(Board, RazoringAlpha, RazoringAlpha + 1, 0, Ply, FALSE, FALSE);
 
-            if (StopSearch) {
+            if (StopSearch || Board->LimitReached) {
                 return 0;
             }
 
             if (Score <= RazoringAlpha) {
+                STAT_INC(Board, STAT_RAZORING);
+
                 return Score;
             }
         }
@@ -268,10 +326,12 @@ int Search(BoardItem* Board, int Alpha, int Beta, int Depth, const int Ply, Move
         if (NonPawnMaterial && Depth > 1 && StaticScore >= Beta) { // Hakkapeliitta
             NullMoveReduction = 3 + Depth / 6;
 
+            STAT_INC(Board, STAT_NULL_MOVE_TRY);
+
             MakeNullMove(Board);
 
 #ifdef HASH_PREFETCH
-            Prefetch(Board->Hash);
+            Prefetch(Board->HashStore, Board->Hash);
 #endif // HASH_PREFETCH
 
             ++Board->Nodes;
@@ -285,11 +345,13 @@ int Search(BoardItem* Board, int Alpha, int Beta, int Depth, const int Ply, Move
 
             UnmakeNullMove(Board);
 
-            if (StopSearch) {
+            if (StopSearch || Board->LimitReached) {
                 return 0;
             }
 
             if (Score >= Beta) {
+                STAT_INC(Board, STAT_NULL_MOVE_PRUNING);
+
                 if (Score >= INF - MAX_PLY) {
                     return Beta;
                 }
@@ -305,27 +367,29 @@ int Search(BoardItem* Board, int Alpha, int Beta, int Depth, const int Ply, Move
             BetaCut = Beta + 100;
 
             GenMoveCount = 0;
-            GenerateCaptureMoves(Board, CMH_Pointer, MoveList, &GenMoveCount);
+            GenerateCaptureMoves(Board, CMH_Pointer, &MoveList, &GenMoveCount);
 
             for (int MoveNumber = 0; MoveNumber < GenMoveCount; ++MoveNumber) {
-                PrepareNextMove(MoveNumber, MoveList, GenMoveCount);
+                PrepareNextMove(MoveNumber, &MoveList, GenMoveCount);
 
-                if (MoveList[MoveNumber].Move == SkipMove) {
+                if (MoveList.Move[MoveNumber] == SkipMove) {
                     continue; // Next move
                 }
 
-                if (!(MoveList[MoveNumber].Type & MOVE_CAPTURE)) {
+                CurrentMove = CreateMoveItem(Board, MoveList.Move[MoveNumber]);
+
+                if (!(CurrentMove.Type & MOVE_CAPTURE)) {
                     continue; // Next move
                 }
 
-                if (SEE(Board, MoveList[MoveNumber].Type, MoveList[MoveNumber].Move) < BetaCut - StaticScore) {
+                if (!SEE_GE(Board, CurrentMove.Type, CurrentMove.Move, BetaCut - StaticScore, &Pinned)) {
                     continue; // Next move
                 }
 
-                MakeMove(Board, MoveList[MoveNumber]);
+                MakeMove(Board, CurrentMove);
 
 #ifdef HASH_PREFETCH
-                Prefetch(Board->Hash);
+                Prefetch(Board->HashStore, Board->Hash);
 #endif // HASH_PREFETCH
 
                 if (IsInCheck(Board, CHANGE_COLOR(Board->CurrentColor))) { // Illegal move
@@ -336,6 +400,8 @@ int Search(BoardItem* Board, int Alpha, int Beta, int Depth, const int Ply, Move
 
                 ++Board->Nodes;
 
+                STAT_INC(Board, STAT_PROBCUT_TRY);
+
                 GiveCheck = IsInCheck(Board, Board->CurrentColor);
 
                 // Zero window quiescence search
@@ -350,11 +416,13 @@ int Search(BoardItem* Board, int Alpha, int Beta, int Depth, const int Ply, Move
 
                 UnmakeMove(Board);
 
-                if (StopSearch) {
+                if (StopSearch || Board->LimitReached) {
                     return 0;
                 }
 
                 if (Score >= BetaCut) {
+                    STAT_INC(Board, STAT_PROBCUT);
+
                     return Score;
                 }
             }
@@ -369,16 +437,18 @@ int Search(BoardItem* Board, int Alpha, int Beta, int Depth, const int Ply, Move
         printf("-- IID: Depth = %d\n", Depth);
 #endif // DEBUG_IID
 
+        STAT_INC(Board, STAT_IID);
+
         // Search with full window for reduced depth
         TempBestMoves[0] = (MoveItem){ 0, 0, 0 }; // End of move list
 
         Search(Board, Alpha, Beta, (IsPrincipal ? Depth - 2 : Depth / 2), Ply, TempBestMoves, IsPrincipal, InCheck, FALSE, 0);
 
-        if (StopSearch) {
+        if (StopSearch || Board->LimitReached) {
             return 0;
         }
 
-        LoadHash(Board->Hash, &HashDepth, Ply, &HashScore, &HashStaticScore, &HashMove, &HashFlag);
+        LoadHash(Board->HashStore, Board->Hash, &HashDepth, Ply, &HashScore, &HashStaticScore, &HashMove, &HashFlag);
 
 #ifdef DEBUG_IID
         if (HashMove) {
@@ -391,17 +461,17 @@ int Search(BoardItem* Board, int Alpha, int Beta, int Depth, const int Ply, Move
     BestScore = -INF + Ply;
 
     GenMoveCount = 0;
-    GenerateAllMoves(Board, CMH_Pointer, MoveList, &GenMoveCount);
+    GenerateAllMoves(Board, CMH_Pointer, &MoveList, &GenMoveCount);
 
-    SetHashMoveSortValue(MoveList, GenMoveCount, HashMove);
+    SetHashMoveSortValue(&MoveList, GenMoveCount, HashMove);
 
 #ifdef KILLER_MOVE
-    SetKillerMove1SortValue(Board, Ply, MoveList, GenMoveCount, HashMove);
-    SetKillerMove2SortValue(Board, Ply, MoveList, GenMoveCount, HashMove);
+    SetKillerMove1SortValue(Board, Ply, &MoveList, GenMoveCount, HashMove);
+    SetKillerMove2SortValue(Board, Ply, &MoveList, GenMoveCount, HashMove);
 #endif // KILLER_MOVE
 
 #ifdef COUNTER_MOVE
-    SetCounterMoveSortValue(Board, Ply, MoveList, GenMoveCount, HashMove);
+    SetCounterMoveSortValue(Board, Ply, &MoveList, GenMoveCount, HashMove);
 #endif // COUNTER_MOVE
 
 #ifdef KILLER_MOVE
@@ -409,38 +479,80 @@ int Search(BoardItem* Board, int Alpha, int Beta, int Depth, const int Ply, Move
     Board->KillerMoveTable[Ply + 1][1] = 0;
 #endif // KILLER_MOVE
 
+    if (Ply == 0) { // Root node
+        Board->RootNodes = Board->Nodes;
+        Board->BestMoveNodes = 0ULL;
+    }
+
     for (int MoveNumber = 0; MoveNumber < GenMoveCount; ++MoveNumber) {
 #ifdef BAD_CAPTURE_LAST
 NextMove:
 #endif // BAD_CAPTURE_LAST
 
-        PrepareNextMove(MoveNumber, MoveList, GenMoveCount);
+#ifdef QUIET_MOVE_PARTIAL_SORT
+        if (!QuietMovesSorted) {
+            PrepareNextMove(MoveNumber, &MoveList, GenMoveCount);
+
+            if (MoveList.SortValue[MoveNumber] < SORT_COUNTER_MOVE_VALUE) { // Only quiet and bad capture moves left
+                SortMoves(MoveNumber, &MoveList, GenMoveCount, SORT_QUIET_MOVE_THRESHOLD(Depth));
+
+                QuietMovesSorted = TRUE;
+            }
+        }
+#else
+        PrepareNextMove(MoveNumber, &MoveList, GenMoveCount);
+#endif // QUIET_MOVE_PARTIAL_SORT
 
-        if (MoveList[MoveNumber].Move == SkipMove) {
+        if (MoveList.Move[MoveNumber] == SkipMove) {
             continue; // Next move
         }
 
+        CurrentMove = CreateMoveItem(Board, MoveList.Move[MoveNumber]);
+
 #ifdef BAD_CAPTURE_LAST
         if (
-            (MoveList[MoveNumber].Type & MOVE_CAPTURE)
-            && !(MoveList[MoveNumber].Type & MOVE_PAWN_PROMOTE)
-            && MoveList[MoveNumber].SortValue >= 0
-            && MoveList[MoveNumber].Move != HashMove
+            (CurrentMove.Type & MOVE_CAPTURE)
+            && !(CurrentMove.Type & MOVE_PAWN_PROMOTE)
+            && MoveList.SortValue[MoveNumber] >= 0
+            && CurrentMove.Move != HashMove
         ) {
-            SEE_Value = SEE(Board, MoveList[MoveNumber].Type, MoveList[MoveNumber].Move);
+            SEE_Value = SEE(Board, CurrentMove.Type, CurrentMove.Move);
 
             if (SEE_Value < 0) { // Bad capture move
-                MoveList[MoveNumber].SortValue = SEE_Value - SORT_CAPTURE_MOVE_BONUS; // Search move later
+                MoveList.SortValue[MoveNumber] = SEE_Value - SORT_CAPTURE_MOVE_BONUS; // Search move later
 
                 goto NextMove;
             }
         }
 #endif // BAD_CAPTURE_LAST
 
-        MakeMove(Board, MoveList[MoveNumber]);
+        // SEE pruning: SEE before the move is made (the gives check condition is tested after the move)
+
+#if defined(SEE_CAPTURE_MOVE_PRUNING) && !defined(BAD_CAPTURE_LAST)
+        BadCaptureMove = (
+            Depth <= 3
+            && !IsPrincipal
+            && !InCheck
+            && CurrentMove.Move != HashMove
+            && !SEE_GE(Board, CurrentMove.Type, CurrentMove.Move, -100 * Depth, &Pinned)
+        );
+#endif // SEE_CAPTURE_MOVE_PRUNING && !BAD_CAPTURE_LAST
+
+#ifdef SEE_QUIET_MOVE_PRUNING
+        BadQuietMove = (
+            Depth <= 3
+            && !IsPrincipal
+            && !InCheck
+            && CurrentMove.Move != HashMove
+            && !(CurrentMove.Type & (MOVE_CAPTURE | MOVE_PAWN_PROMOTE)) // Not capture/promote move
+            && !SEE_GE(Board, CurrentMove.Type, CurrentMove.Move, 0, &Pinned)
+        );
+#endif // SEE_QUIET_MOVE_PRUNING
+
+        MakeMove(Board, CurrentMove);
 
 #ifdef HASH_PREFETCH
-        Prefetch(Board->Hash);
+        Prefetch(Board->HashStore, Board->Hash);
 #endif // HASH_PREFETCH
 
         if (IsInCheck(Board, CHANGE_COLOR(Board->CurrentColor))) { // Illegal move
@@ -451,6 +563,10 @@ NextMove:
 
         ++LegalMoveCount;
 
+        if (Ply == 0) { // Root node
+            RootMoveNodes = Board->Nodes;
+        }
+
         ++Board->Nodes;
 
 #ifdef PRINT_CURRENT_MOVE
@@ -458,13 +574,17 @@ NextMove:
             if (Ply == 0 && PrintMode == PRINT_MODE_UCI && (Clock() - TimeStart) >= 3000ULL) {
 #pragma omp critical
                 {
-                    printf("info depth %d currmovenumber %d currmove %s%s", Depth, MoveNumber + 1, BoardName[MOVE_FROM(MoveList[MoveNumber].Move)], BoardName[MOVE_TO(MoveList[MoveNumber].Move)]);
+                    _lock_file(stdout); // The line is not mixed with "readyok" (UCI input thread)
 
-                    if (MoveList[MoveNumber].Type & MOVE_PAWN_PROMOTE) {
-                        printf("%c", PiecesCharBlack[MOVE_PROMOTE_PIECE_TYPE(MoveList[MoveNumber].Move)]);
+                    printf("info depth %d currmovenumber %d currmove %s%s", Depth, MoveNumber + 1, BoardName[MOVE_FROM(CurrentMove.Move)], BoardName[MOVE_TO(CurrentMove.Move)]);
+
+                    if (CurrentMove.Type & MOVE_PAWN_PROMOTE) {
+                        printf("%c", PiecesCharBlack[MOVE_PROMOTE_PIECE_TYPE(CurrentMove.Move)]);
                     }
 
                     printf("\n");
+
+                    _unlock_file(stdout);
                 }
             }
         }
@@ -476,6 +596,8 @@ NextMove:
 
 #ifdef CHECK_EXTENSION
         if (!Extension && GiveCheck) {
+            STAT_INC(Board, STAT_CHECK_EXTENSION);
+
             Extension = 1;
         }
 #endif // CHECK_EXTENSION
@@ -486,7 +608,7 @@ NextMove:
             && !SkipMove
             && Ply > 0
             && Depth >= 8
-            && MoveList[MoveNumber].Move == HashMove
+            && CurrentMove.Move == HashMove
             && HashFlag == HASH_BETA
             && HashDepth >= Depth - 3
             && (HashScore > -INF + MAX_PLY && HashScore < INF - MAX_PLY)
@@ -495,19 +617,21 @@ NextMove:
 
             SingularBeta = HashScore - Depth;
 
+            STAT_INC(Board, STAT_SINGULAR_TRY);
+
             // Zero window search for reduced depth
             TempBestMoves[0] = (MoveItem){ 0, 0, 0 }; // End of move list
 
-            Score = Search(Board, SingularBeta - 1, SingularBeta, Depth / 2, Ply, TempBestMoves, FALSE, InCheck, FALSE, MoveList[MoveNumber].Move);
+            Score = Search(Board, SingularBeta - 1, SingularBeta, Depth / 2, Ply, TempBestMoves, FALSE, InCheck, FALSE, CurrentMove.Move);
 
-            if (StopSearch) {
+            if (StopSearch || Board->LimitReached) {
                 return 0;
             }
 
 #ifdef DEBUG_SINGULAR_EXTENSION
             PrintBoard(Board);
 
-            printf("-- SE: Ply = %d Depth = %d SkipMove = %s%s HashScore = %d SingularBeta = %d Score = %d\n", Ply, Depth, BoardName[MOVE_FROM(MoveList[MoveNumber].Move)], BoardName[MOVE_TO(MoveList[MoveNumber].Move)], HashScore, SingularBeta, Score);
+            printf("-- SE: Ply = %d Depth = %d SkipMove = %s%s HashScore = %d SingularBeta = %d Score = %d\n", Ply, Depth, BoardName[MOVE_FROM(CurrentMove.Move)], BoardName[MOVE_TO(CurrentMove.Move)], HashScore, SingularBeta, Score);
 #endif // DEBUG_SINGULAR_EXTENSION
 
             if (Score < SingularBeta) {
@@ -515,20 +639,24 @@ NextMove:
                 printf("-- SE: Extension = 1\n");
 #endif // DEBUG_SINGULAR_EXTENSION
 
+                STAT_INC(Board, STAT_SINGULAR_EXTENSION);
+
                 Extension = 1;
             }
 
-            MakeMove(Board, MoveList[MoveNumber]);
+            MakeMove(Board, CurrentMove);
         }
 #endif // SINGULAR_EXTENSION
 
 #if defined(COUNTER_MOVE_HISTORY) && defined(COUNTER_MOVE_HISTORY_EXTENSION)
         if (
             !Extension
-            && !(MoveList[MoveNumber].Type & (MOVE_CAPTURE | MOVE_PAWN_PROMOTE)) // Not capture/promote move
-            && (CMH_Pointer[0] && CMH_Pointer[0][(PIECE_TYPE(Board->Pieces[MOVE_FROM(MoveList[MoveNumber].Move)]) << 6) + MOVE_TO(MoveList[MoveNumber].Move)] >= MAX_HEURISTIC_SCORE / 2)
-            && (CMH_Pointer[1] && CMH_Pointer[1][(PIECE_TYPE(Board->Pieces[MOVE_FROM(MoveList[MoveNumber].Move)]) << 6) + MOVE_TO(MoveList[MoveNumber].Move)] >= MAX_HEURISTIC_SCORE / 2)
+            && !(CurrentMove.Type & (MOVE_CAPTURE | MOVE_PAWN_PROMOTE)) // Not capture/promote move
+            && (CMH_Pointer[0] && CMH_Pointer[0][(PIECE_TYPE(Board->Pieces[MOVE_FROM(CurrentMove.Move)]) << 6) + MOVE_TO(CurrentMove.Move)] >= MAX_HEURISTIC_SCORE / 2)
+            && (CMH_Pointer[1] && CMH_Pointer[1][(PIECE_TYPE(Board->Pieces[MOVE_FROM(CurrentMove.Move)]) << 6) + MOVE_TO(CurrentMove.Move)] >= MAX_HEURISTIC_SCORE / 2)
         ) { // Xiphos
+            STAT_INC(Board, STAT_CMH_EXTENSION);
+
             Extension = 1;
         }
 #endif // COUNTER_MOVE_HISTORY && COUNTER_MOVE_HISTORY_EXTENSION
@@ -539,34 +667,38 @@ NextMove:
             && !IsPrincipal
             && !InCheck
             && !GiveCheck
-            && MoveList[MoveNumber].Move != HashMove
+            && CurrentMove.Move != HashMove
         ) {
 #ifdef SEE_CAPTURE_MOVE_PRUNING
             if (Depth <= 3) {
 #ifdef BAD_CAPTURE_LAST
-                if (MoveList[MoveNumber].SortValue + SORT_CAPTURE_MOVE_BONUS < -100 * Depth) { // Bad capture move (Xiphos)
+                if (MoveList.SortValue[MoveNumber] + SORT_CAPTURE_MOVE_BONUS < -100 * Depth) { // Bad capture move (Xiphos)
+                    STAT_INC(Board, STAT_SEE_CAPTURE_MOVE_PRUNING);
+
                     UnmakeMove(Board);
 
                     continue; // Next move
                 }
 #else
-                UnmakeMove(Board);
+                if (BadCaptureMove) { // Bad capture move (Xiphos)
+                    STAT_INC(Board, STAT_SEE_CAPTURE_MOVE_PRUNING);
+
+                    UnmakeMove(Board);
 
-                if (SEE(Board, MoveList[MoveNumber].Type, MoveList[MoveNumber].Move) < -100 * Depth) { // Bad capture move (Xiphos)
                     continue; // Next move
                 }
-
-                MakeMove(Board, MoveList[MoveNumber]);
 #endif // BAD_CAPTURE_LAST
             }
 #endif // SEE_CAPTURE_MOVE_PRUNING
 
 #if defined(FUTILITY_PRUNING) || defined(LATE_MOVE_PRUNING) || defined(SEE_QUIET_MOVE_PRUNING)
-            if (!(MoveList[MoveNumber].Type & (MOVE_CAPTURE | MOVE_PAWN_PROMOTE))) { // Not capture/promote move
+            if (!(CurrentMove.Type & (MOVE_CAPTURE | MOVE_PAWN_PROMOTE))) { // Not capture/promote move
 #ifdef FUTILITY_PRUNING
                 if (Depth <= 7 && (StaticScore + FutilityMargin(Depth)) <= Alpha) { // Hakkapeliitta
                     BestScore = MAX(BestScore, StaticScore + FutilityMargin(Depth));
 
+                    STAT_INC(Board, STAT_FUTILITY_PRUNING);
+
                     UnmakeMove(Board);
 
                     continue; // Next move
@@ -575,6 +707,8 @@ NextMove:
 
 #ifdef LATE_MOVE_PRUNING
                 if (Depth <= 6 && MoveNumber >= LateMovePruningTable[Depth]) { // Hakkapeliitta
+                    STAT_INC(Board, STAT_LATE_MOVE_PRUNING);
+
                     UnmakeMove(Board);
 
                     continue; // Next move
@@ -582,14 +716,12 @@ NextMove:
 #endif // LATE_MOVE_PRUNING
 
 #ifdef SEE_QUIET_MOVE_PRUNING
-                if (Depth <= 3) { // Hakkapeliitta
-                    UnmakeMove(Board);
+                if (BadQuietMove) { // Bad quiet move (Hakkapeliitta)
+                    STAT_INC(Board, STAT_SEE_QUIET_MOVE_PRUNING);
 
-                    if (SEE(Board, MoveList[MoveNumber].Type, MoveList[MoveNumber].Move) < 0) { // Bad quiet move
-                        continue; // Next move
-                    }
+                    UnmakeMove(Board);
 
-                    MakeMove(Board, MoveList[MoveNumber]);
+                    continue; // Next move
                 }
 #endif // SEE_QUIET_MOVE_PRUNING
             }
@@ -611,8 +743,8 @@ NextMove:
                 !Extension
                 && !InCheck
                 && !GiveCheck
-                && !(MoveList[MoveNumber].Type & (MOVE_CAPTURE | MOVE_PAWN_PROMOTE)) // Not capture/promote move
-                && MoveList[MoveNumber].Move != HashMove
+                && !(CurrentMove.Type & (MOVE_CAPTURE | MOVE_PAWN_PROMOTE)) // Not capture/promote move
+                && CurrentMove.Move != HashMove
                 && Depth >= 5
             ) {
                 LateMoveReduction = LateMoveReductionTable[MIN(Depth, 63)][MIN(MoveNumber, 63)]; // Hakkapeliitta
@@ -620,6 +752,10 @@ NextMove:
                 if (IsPrincipal) {
                     --LateMoveReduction;
                 }
+
+                if (LateMoveReduction > 0) {
+                    STAT_INC(Board, STAT_LATE_MOVE_REDUCTION);
+                }
             }
             else {
                 LateMoveReduction = 0;
@@ -631,6 +767,7 @@ NextMove:
             Score = -Search(Board, -Alpha - 1, -Alpha, NewDepth - LateMoveReduction, Ply + 1, TempBestMoves, FALSE, GiveCheck, TRUE, 0);
 
             if (LateMoveReduction > 0 && Score > Alpha) {
+                STAT_INC(Board, STAT_LATE_MOVE_RESEARCH);
 #endif // LATE_MOVE_REDUCTION
                 // Zero window search
                 TempBestMoves[0] = (MoveItem){ 0, 0, 0 }; // End of move list
@@ -641,6 +778,8 @@ NextMove:
 #endif // LATE_MOVE_REDUCTION
 
             if (IsPrincipal && Score > Alpha && (Ply == 0 || Score < Beta)) {
+                STAT_INC(Board, STAT_PRINCIPAL_RESEARCH);
+
                 // Search with full window
                 TempBestMoves[0] = (MoveItem){ 0, 0, 0 }; // End of move list
 
@@ -650,7 +789,7 @@ NextMove:
 
         UnmakeMove(Board);
 
-        if (StopSearch) {
+        if (StopSearch || Board->LimitReached) {
             return 0;
         }
 
@@ -658,19 +797,12 @@ NextMove:
             BestScore = Score;
 
             if (BestScore > Alpha) {
-                BestMove = MoveList[MoveNumber];
+                BestMove = CurrentMove;
 
                 if (IsPrincipal) {
                     if (omp_get_thread_num() == 0) { // Master thread
                         if (Ply == 0) { // Root node
-                            if (BestMove.Move == BestMoves[0].Move) { // Move not changed
-                                if (TimeStep > 0) {
-                                    --TimeStep;
-                                }
-                            }
-                            else { // Move changed
-                                TimeStep = MAX_TIME_STEPS - 1;
-                            }
+                            Board->BestMoveNodes = Board->Nodes - RootMoveNodes;
                         }
                     }
 
@@ -681,9 +813,11 @@ NextMove:
                     Alpha = BestScore;
                 }
                 else { // !IsPrincipal || BestScore >= Beta
-#ifdef USE_STATISTIC
-                    ++Board->CutoffCount;
-#endif // USE_STATISTIC
+                    STAT_INC(Board, STAT_CUTOFF);
+
+                    if (LegalMoveCount == 1) {
+                        STAT_INC(Board, STAT_FIRST_MOVE_CUTOFF);
+                    }
 
                     if (!(BestMove.Type & (MOVE_CAPTURE | MOVE_PAWN_PROMOTE))) { // Not capture/promote move
                         UpdateHeuristic(Board, CMH_Pointer, BestMove.Move, BONUS(Depth));
@@ -706,8 +840,8 @@ NextMove:
             } // if
         } // if
 
-        if (!(MoveList[MoveNumber].Type & (MOVE_CAPTURE | MOVE_PAWN_PROMOTE))) { // Not capture/promote move
-            QuietMoveList[QuietMoveCount++] = MoveList[MoveNumber].Move;
+        if (!(CurrentMove.Type & (MOVE_CAPTURE | MOVE_PAWN_PROMOTE))) { // Not capture/promote move
+            QuietMoveList[QuietMoveCount++] = CurrentMove.Move;
         }
     } // for
 
@@ -734,8 +868,86 @@ NextMove:
             HashFlag = HASH_ALPHA;
         }
 
-        SaveHash(Board->Hash, Depth, Ply, BestScore, StaticScore, BestMove.Move, HashFlag);
+        SaveHash(Board->HashStore, Board->Hash, Depth, Ply, BestScore, StaticScore, BestMove.Move, HashFlag);
+    }
+
+    return BestScore;
+}
+
+/*
+    Iterative deepening on one thread (one search per thread: data generation, EPD test, evaluate file)
+
+    Node and time limits are checked inside the search (the first depth is always completed; the interrupted depth is discarded).
+    Best moves (Board->BestMovesRoot) and score are of the last completed depth; Board->Nodes is the total of all depths.
+*/
+int SearchIterative(BoardItem* Board, const int SearchDepth, const U64 SearchNodes, const U64 SearchTime, const BOOL InCheck, DepthDoneFunction DepthDone, void* Data)
+{
+    int Score;
+    int BestScore = 0;
+
+    MoveItem BestMoves[MAX_PLY]; // The last completed depth
+
+    U64 SearchTimeStart = Clock();
+
+    BestMoves[0] = (MoveItem){ 0, 0, 0 }; // End of move list
+
+    Board->BestMovesRoot[0] = (MoveItem){ 0, 0, 0 }; // End of move list
+
+    ClearHeuristic(Board);
+
+#ifdef KILLER_MOVE
+    ClearKillerMove(Board);
+#endif // KILLER_MOVE
+
+#ifdef COUNTER_MOVE
+    ClearCounterMove(Board);
+#endif // COUNTER_MOVE
+
+    Board->Nodes = 0ULL;
+
+    for (int Depth = 1; Depth <= SearchDepth; ++Depth) {
+        Board->SelDepth = 0;
+
+        Board->NodeLimit = (SearchNodes > 0ULL && Depth > 1) ? SearchNodes : 0ULL;
+        Board->TimeLimit = (SearchTime > 0ULL && Depth > 1) ? SearchTimeStart + SearchTime : 0ULL;
+        Board->LimitReached = FALSE;
+
+        Score = Search(Board, -INF, INF, Depth, 0, Board->BestMovesRoot, TRUE, InCheck, FALSE, 0);
+
+        if (Board->LimitReached) { // Node or time limit (the depth is not completed)
+            memcpy(Board->BestMovesRoot, BestMoves, sizeof(BestMoves));
+
+            break; // for (depth)
+        }
+
+        BestScore = Score;
+
+        memcpy(BestMoves, Board->BestMovesRoot, sizeof(BestMoves));
+
+        if (DepthDone) {
+            DepthDone(Board, Depth, Score, Data);
+        }
+
+        if (!Board->BestMovesRoot[0].Move) { // No legal moves
+            break; // for (depth)
+        }
+
+        if (Score <= -INF + Depth || Score >= INF - Depth) { // Checkmate
+            break; // for (depth)
+        }
+
+        if (SearchNodes > 0ULL && Board->Nodes >= SearchNodes) { // Node limit (the first depth)
+            break; // for (depth)
+        }
+
+        if (SearchTime > 0ULL && Clock() - SearchTimeStart >= SearchTime) { // Time limit (the next depth is not started)
+            break; // for (depth)
+        }
     }
 
+    Board->NodeLimit = 0ULL;
+    Board->TimeLimit = 0ULL;
+    Board->LimitReached = FALSE;
+
     return BestScore;
 }
\ No newline at end of file
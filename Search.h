@@ -9,6 +9,10 @@
 #include "Def.h"
 #include "Types.h"
 
+typedef void (*DepthDoneFunction)(const BoardItem* Board, const int Depth, const int Score, void* Data); // After each completed depth
+
 int Search(BoardItem* Board, int Alpha, int Beta, int Depth, const int Ply, MoveItem* BestMoves, const BOOL IsPrincipal, const BOOL InCheck, const BOOL UsePruning, const int SkipMove);
 
+int SearchIterative(BoardItem* Board, const int SearchDepth, const U64 SearchNodes, const U64 SearchTime, const BOOL InCheck, DepthDoneFunction DepthDone, void* Data);
+
 #endif // !SEARCH_H
\ No newline at end of file
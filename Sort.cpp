@@ -4,56 +4,144 @@
 
 #include "Sort.h"
 
+#include "BitBoard.h"
 #include "Board.h"
 #include "Def.h"
 #include "Heuristic.h"
+#include "Move.h"
+#include "Types.h"
 
-void SetHashMoveSortValue(MoveItem* GenMoveList, const int GenMoveCount, const int HashMove)
+int FindMoveIndex(const MoveListItem* GenMoveList, const int GenMoveCount, const int Move)
 {
+#ifdef USE_SORT_AVX2
+    const __m256i Key = _mm256_set1_epi16((short)Move);
+
+    int Mask;
+    int Index;
+
+    for (int StartIndex = 0; StartIndex < GenMoveCount; StartIndex += 16) { // 16 moves per register
+        Mask = _mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_loadu_si256((__m256i*)&GenMoveList->Move[StartIndex]), Key));
+
+        if (Mask) {
+            Index = StartIndex + LSB((U64)(unsigned int)Mask) / 2; // 2 bits per move
+
+            return (Index < GenMoveCount ? Index : -1);
+        }
+    }
+#else
+    for (int Index = 0; Index < GenMoveCount; ++Index) {
+        if (GenMoveList->Move[Index] == Move) {
+            return Index;
+        }
+    }
+#endif // USE_SORT_AVX2
+
+    return -1;
+}
+
+#ifdef USE_SORT_AVX2
+void SetQuietMoveSortValues(const BoardItem* Board, int** CMH_Pointer, MoveListItem* GenMoveList, const int GenMoveCount)
+{
+    const __m256i ConstLaneIndex = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i Const63 = _mm256_set1_epi32(63);
+    const __m256i Const7 = _mm256_set1_epi32(7);
+    const __m256i ConstCaptureBonus = _mm256_set1_epi32(SORT_CAPTURE_MOVE_BONUS);
+    const __m256i ConstMoveCount = _mm256_set1_epi32(GenMoveCount);
+
+    const int* HeuristicTable = &Board->HeuristicTable[Board->CurrentColor][0][0];
+
+    const int* CMH_Table0 = CMH_Pointer ? CMH_Pointer[0] : NULL;
+    const int* CMH_Table1 = CMH_Pointer ? CMH_Pointer[1] : NULL;
+
+    __m256i Moves;
+    __m256i From;
+    __m256i To;
+    __m256i PieceType;
+    __m256i HistoryIndex;
+    __m256i SortValues;
+    __m256i QuietMask;
+    __m256i Values;
+
+    for (int Index = 0; Index < GenMoveCount; Index += 8) { // 8 moves per register
+        Moves = _mm256_cvtepu16_epi32(_mm_loadu_si128((__m128i*)&GenMoveList->Move[Index]));
+        SortValues = _mm256_load_si256((__m256i*)&GenMoveList->SortValue[Index]);
+
+        // Quiet moves (not capture/promote) inside the move list
+        QuietMask = _mm256_and_si256(
+            _mm256_cmpgt_epi32(ConstCaptureBonus, SortValues),
+            _mm256_cmpgt_epi32(ConstMoveCount, _mm256_add_epi32(_mm256_set1_epi32(Index), ConstLaneIndex))
+        );
+
+        if (_mm256_testz_si256(QuietMask, QuietMask)) {
+            continue; // Next moves
+        }
+
+        From = _mm256_and_si256(_mm256_srli_epi32(Moves, 6), Const63);
+        To = _mm256_and_si256(Moves, Const63);
+
+        PieceType = _mm256_and_si256(_mm256_i32gather_epi32(Board->Pieces, From, 4), Const7);
+
+        HistoryIndex = _mm256_or_si256(_mm256_slli_epi32(PieceType, 6), To); // (Piece << 6) + To
+
+        Values = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), HeuristicTable, HistoryIndex, QuietMask, 4);
+
+#ifdef COUNTER_MOVE_HISTORY
+        if (CMH_Table0) {
+            Values = _mm256_add_epi32(Values, _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), CMH_Table0, HistoryIndex, QuietMask, 4));
+        }
+
+        if (CMH_Table1) {
+            Values = _mm256_add_epi32(Values, _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), CMH_Table1, HistoryIndex, QuietMask, 4));
+        }
+#endif // COUNTER_MOVE_HISTORY
+
+        _mm256_store_si256((__m256i*)&GenMoveList->SortValue[Index], _mm256_blendv_epi8(SortValues, Values, QuietMask));
+    }
+}
+#endif // USE_SORT_AVX2
+
+void SetHashMoveSortValue(MoveListItem* GenMoveList, const int GenMoveCount, const int HashMove)
+{
+    int Index;
+
     if (HashMove) {
-        for (int Index = 0; Index < GenMoveCount; ++Index) {
-            if (GenMoveList[Index].Move == HashMove) {
-                GenMoveList[Index].SortValue = SORT_HASH_MOVE_VALUE;
+        Index = FindMoveIndex(GenMoveList, GenMoveCount, HashMove);
 
-                break;
-            }
+        if (Index != -1) {
+            GenMoveList->SortValue[Index] = SORT_HASH_MOVE_VALUE;
         }
     }
 }
 
 #ifdef KILLER_MOVE
 
-void SetKillerMove1SortValue(const BoardItem* Board, const int Ply, MoveItem* GenMoveList, const int GenMoveCount, const int HashMove)
+void SetKillerMove1SortValue(const BoardItem* Board, const int Ply, MoveListItem* GenMoveList, const int GenMoveCount, const int HashMove)
 {
     int KillerMove1 = Board->KillerMoveTable[Ply][0];
 
+    int Index;
+
     if (KillerMove1 && KillerMove1 != HashMove) {
-        for (int Index = 0; Index < GenMoveCount; ++Index) {
-            if (GenMoveList[Index].Move == KillerMove1) {
-                if (!(GenMoveList[Index].Type & (MOVE_CAPTURE | MOVE_PAWN_PROMOTE))) { // Not capture/promote move
-                    GenMoveList[Index].SortValue = SORT_KILLER_MOVE_1_VALUE;
-                }
+        Index = FindMoveIndex(GenMoveList, GenMoveCount, KillerMove1);
 
-                break;
-            }
+        if (Index != -1 && !(GetMoveType(Board, KillerMove1) & (MOVE_CAPTURE | MOVE_PAWN_PROMOTE))) { // Not capture/promote move
+            GenMoveList->SortValue[Index] = SORT_KILLER_MOVE_1_VALUE;
         }
     }
 }
 
-void SetKillerMove2SortValue(const BoardItem* Board, const int Ply, MoveItem* GenMoveList, const int GenMoveCount, const int HashMove)
+void SetKillerMove2SortValue(const BoardItem* Board, const int Ply, MoveListItem* GenMoveList, const int GenMoveCount, const int HashMove)
 {
     int KillerMove1 = Board->KillerMoveTable[Ply][0];
     int KillerMove2 = Board->KillerMoveTable[Ply][1];
 
+    int Index;
+
     if (KillerMove2 && KillerMove2 != HashMove && KillerMove2 != KillerMove1) {
-        for (int Index = 0; Index < GenMoveCount; ++Index) {
-            if (GenMoveList[Index].Move == KillerMove2) {
-                if (!(GenMoveList[Index].Type & (MOVE_CAPTURE | MOVE_PAWN_PROMOTE))) { // Not capture/promote move
-                    GenMoveList[Index].SortValue = SORT_KILLER_MOVE_2_VALUE;
-                }
+        Index = FindMoveIndex(GenMoveList, GenMoveCount, KillerMove2);
 
-                break;
-            }
+        if (Index != -1 && !(GetMoveType(Board, KillerMove2) & (MOVE_CAPTURE | MOVE_PAWN_PROMOTE))) { // Not capture/promote move
+            GenMoveList->SortValue[Index] = SORT_KILLER_MOVE_2_VALUE;
         }
     }
 }
@@ -61,7 +149,7 @@ void SetKillerMove2SortValue(const BoardItem* Board, const int Ply, MoveItem* Ge
 #endif // KILLER_MOVE
 
 #ifdef COUNTER_MOVE
-void SetCounterMoveSortValue(const BoardItem* Board, const int Ply, MoveItem* GenMoveList, const int GenMoveCount, const int HashMove)
+void SetCounterMoveSortValue(const BoardItem* Board, const int Ply, MoveListItem* GenMoveList, const int GenMoveCount, const int HashMove)
 {
     if (Ply == 0) {
         return;
@@ -75,6 +163,8 @@ void SetCounterMoveSortValue(const BoardItem* Board, const int Ply, MoveItem* Ge
 
     int CounterMove = Board->CounterMoveTable[CHANGE_COLOR(Board->CurrentColor)][Info->PieceTypeFrom][Info->To];
 
+    int Index;
+
 #ifdef KILLER_MOVE
     int KillerMove1 = Board->KillerMoveTable[Ply][0];
     int KillerMove2 = Board->KillerMoveTable[Ply][1];
@@ -85,36 +175,165 @@ void SetCounterMoveSortValue(const BoardItem* Board, const int Ply, MoveItem* Ge
 #else
     if (CounterMove && CounterMove != HashMove) {
 #endif // KILLER_MOVE
-        for (int Index = 0; Index < GenMoveCount; ++Index) {
-            if (GenMoveList[Index].Move == CounterMove) {
-                if (!(GenMoveList[Index].Type & (MOVE_CAPTURE | MOVE_PAWN_PROMOTE))) { // Not capture/promote move
-                    GenMoveList[Index].SortValue = SORT_COUNTER_MOVE_VALUE;
-                }
+        Index = FindMoveIndex(GenMoveList, GenMoveCount, CounterMove);
 
-                break;
-            }
+        if (Index != -1 && !(GetMoveType(Board, CounterMove) & (MOVE_CAPTURE | MOVE_PAWN_PROMOTE))) { // Not capture/promote move
+            GenMoveList->SortValue[Index] = SORT_COUNTER_MOVE_VALUE;
         }
     }
 }
 #endif // COUNTER_MOVE
 
-void PrepareNextMove(const int StartIndex, MoveItem* GenMoveList, const int GenMoveCount)
+void PrepareNextMove(const int StartIndex, MoveListItem* GenMoveList, const int GenMoveCount)
 {
     int BestMoveIndex = StartIndex;
-    int BestMoveScore = GenMoveList[StartIndex].SortValue;
+    int BestMoveScore = GenMoveList->SortValue[StartIndex];
+
+    U16 TempMove;
+
+#ifdef USE_SORT_AVX2
+    __m256i Max;
+    __m128i Max128;
+    __m256i Key;
+
+    int Index = StartIndex + 1;
+
+    int Mask;
+
+    if (GenMoveCount - Index >= 8) {
+        // Max. sort value
+
+        Max = _mm256_set1_epi32(BestMoveScore);
+
+        for (; Index + 8 <= GenMoveCount; Index += 8) {
+            Max = _mm256_max_epi32(Max, _mm256_loadu_si256((__m256i*)&GenMoveList->SortValue[Index]));
+        }
 
-    MoveItem TempMoveItem;
+        Max128 = _mm_max_epi32(_mm256_castsi256_si128(Max), _mm256_extracti128_si256(Max, 1));
+        Max128 = _mm_max_epi32(Max128, _mm_shuffle_epi32(Max128, _MM_SHUFFLE(1, 0, 3, 2)));
+        Max128 = _mm_max_epi32(Max128, _mm_shuffle_epi32(Max128, _MM_SHUFFLE(2, 3, 0, 1)));
 
+        BestMoveScore = _mm_cvtsi128_si32(Max128);
+
+        for (; Index < GenMoveCount; ++Index) {
+            if (GenMoveList->SortValue[Index] > BestMoveScore) {
+                BestMoveScore = GenMoveList->SortValue[Index];
+            }
+        }
+
+        // First move with max. sort value
+
+        Key = _mm256_set1_epi32(BestMoveScore);
+
+        for (Index = StartIndex; Index + 8 <= GenMoveCount; Index += 8) {
+            Mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256((__m256i*)&GenMoveList->SortValue[Index]), Key)));
+
+            if (Mask) {
+                Index += LSB((U64)(unsigned int)Mask);
+
+                break; // for
+            }
+        }
+
+        while (GenMoveList->SortValue[Index] != BestMoveScore) { // Tail
+            ++Index;
+        }
+
+        BestMoveIndex = Index;
+    }
+    else {
+        for (; Index < GenMoveCount; ++Index) {
+            if (GenMoveList->SortValue[Index] > BestMoveScore) {
+                BestMoveIndex = Index;
+                BestMoveScore = GenMoveList->SortValue[Index];
+            }
+        }
+    }
+#else
     for (int Index = StartIndex + 1; Index < GenMoveCount; ++Index) {
-        if (GenMoveList[Index].SortValue > BestMoveScore) {
+        if (GenMoveList->SortValue[Index] > BestMoveScore) {
             BestMoveIndex = Index;
-            BestMoveScore = GenMoveList[Index].SortValue;
+            BestMoveScore = GenMoveList->SortValue[Index];
         }
     }
+#endif // USE_SORT_AVX2
 
     if (StartIndex != BestMoveIndex) {
-        TempMoveItem = GenMoveList[StartIndex];
-        GenMoveList[StartIndex] = GenMoveList[BestMoveIndex];
-        GenMoveList[BestMoveIndex] = TempMoveItem;
+        TempMove = GenMoveList->Move[StartIndex];
+        GenMoveList->Move[StartIndex] = GenMoveList->Move[BestMoveIndex];
+        GenMoveList->Move[BestMoveIndex] = TempMove;
+
+        GenMoveList->SortValue[BestMoveIndex] = GenMoveList->SortValue[StartIndex];
+        GenMoveList->SortValue[StartIndex] = BestMoveScore;
+    }
+}
+
+#ifdef QUIET_MOVE_PARTIAL_SORT
+void SortMoves(const int StartIndex, MoveListItem* GenMoveList, const int GenMoveCount, const int Threshold) // Stockfish (partial insertion sort)
+{
+    int SortedEnd = StartIndex;
+
+    int TempMove;
+    int TempSortValue;
+
+    int Index;
+
+#ifdef BAD_CAPTURE_LAST
+    int BadCaptureStart = GenMoveCount;
+#endif // BAD_CAPTURE_LAST
+
+    for (int NextIndex = StartIndex + 1; NextIndex < GenMoveCount; ++NextIndex) {
+        if (GenMoveList->SortValue[NextIndex] < Threshold) {
+            continue; // Next move
+        }
+
+        TempMove = GenMoveList->Move[NextIndex];
+        TempSortValue = GenMoveList->SortValue[NextIndex];
+
+        ++SortedEnd;
+
+        GenMoveList->Move[NextIndex] = GenMoveList->Move[SortedEnd];
+        GenMoveList->SortValue[NextIndex] = GenMoveList->SortValue[SortedEnd];
+
+        for (Index = SortedEnd; Index > StartIndex && GenMoveList->SortValue[Index - 1] < TempSortValue; --Index) {
+            GenMoveList->Move[Index] = GenMoveList->Move[Index - 1];
+            GenMoveList->SortValue[Index] = GenMoveList->SortValue[Index - 1];
+        }
+
+        GenMoveList->Move[Index] = (U16)TempMove;
+        GenMoveList->SortValue[Index] = TempSortValue;
+    }
+
+#ifdef BAD_CAPTURE_LAST
+    // Bad capture moves after the unsorted quiet moves (the best SEE first)
+
+    for (int NextIndex = GenMoveCount - 1; NextIndex > SortedEnd; --NextIndex) {
+        if (GenMoveList->SortValue[NextIndex] >= SORT_BAD_CAPTURE_MOVE_VALUE) {
+            continue; // Next move (quiet move)
+        }
+
+        TempMove = GenMoveList->Move[NextIndex];
+        TempSortValue = GenMoveList->SortValue[NextIndex];
+
+        // Quiet moves (same order) to the left
+
+        for (Index = NextIndex; Index < BadCaptureStart - 1; ++Index) {
+            GenMoveList->Move[Index] = GenMoveList->Move[Index + 1];
+            GenMoveList->SortValue[Index] = GenMoveList->SortValue[Index + 1];
+        }
+
+        --BadCaptureStart;
+
+        // Insert into the sorted bad capture moves
+
+        for (Index = BadCaptureStart; Index < GenMoveCount - 1 && GenMoveList->SortValue[Index + 1] > TempSortValue; ++Index) {
+            GenMoveList->Move[Index] = GenMoveList->Move[Index + 1];
+            GenMoveList->SortValue[Index] = GenMoveList->SortValue[Index + 1];
+        }
+
+        GenMoveList->Move[Index] = (U16)TempMove;
+        GenMoveList->SortValue[Index] = TempSortValue;
     }
-}
\ No newline at end of file
+#endif // BAD_CAPTURE_LAST
+}
+#endif // QUIET_MOVE_PARTIAL_SORT
\ No newline at end of file
@@ -18,17 +18,33 @@
 
 #define SORT_COUNTER_MOVE_VALUE         (SORT_KILLER_MOVE_2_VALUE - 1)
 
-void SetHashMoveSortValue(MoveItem* GenMoveList, const int GenMoveCount, const int HashMove);
+#ifdef QUIET_MOVE_PARTIAL_SORT
+#define SORT_QUIET_MOVE_THRESHOLD(Depth)    (-4096 * (Depth))
+#endif // QUIET_MOVE_PARTIAL_SORT
+
+#ifdef BAD_CAPTURE_LAST
+#define SORT_BAD_CAPTURE_MOVE_VALUE     (-SORT_CAPTURE_MOVE_BONUS / 2) // Below: bad capture moves (SEE - SORT_CAPTURE_MOVE_BONUS)
+#endif // BAD_CAPTURE_LAST
+
+#ifdef USE_SORT_AVX2
+void SetQuietMoveSortValues(const BoardItem* Board, int** CMH_Pointer, MoveListItem* GenMoveList, const int GenMoveCount);
+#endif // USE_SORT_AVX2
+
+void SetHashMoveSortValue(MoveListItem* GenMoveList, const int GenMoveCount, const int HashMove);
 
 #ifdef KILLER_MOVE
-void SetKillerMove1SortValue(const BoardItem* Board, const int Ply, MoveItem* GenMoveList, const int GenMoveCount, const int HashMove);
-void SetKillerMove2SortValue(const BoardItem* Board, const int Ply, MoveItem* GenMoveList, const int GenMoveCount, const int HashMove);
+void SetKillerMove1SortValue(const BoardItem* Board, const int Ply, MoveListItem* GenMoveList, const int GenMoveCount, const int HashMove);
+void SetKillerMove2SortValue(const BoardItem* Board, const int Ply, MoveListItem* GenMoveList, const int GenMoveCount, const int HashMove);
 #endif // KILLER_MOVE
 
 #ifdef COUNTER_MOVE
-void SetCounterMoveSortValue(const BoardItem* Board, const int Ply, MoveItem* GenMoveList, const int GenMoveCount, const int HashMove);
+void SetCounterMoveSortValue(const BoardItem* Board, const int Ply, MoveListItem* GenMoveList, const int GenMoveCount, const int HashMove);
 #endif // COUNTER_MOVE
 
-void PrepareNextMove(const int StartIndex, MoveItem* GenMoveList, const int GenMoveCount);
+void PrepareNextMove(const int StartIndex, MoveListItem* GenMoveList, const int GenMoveCount);
+
+#ifdef QUIET_MOVE_PARTIAL_SORT
+void SortMoves(const int StartIndex, MoveListItem* GenMoveList, const int GenMoveCount, const int Threshold);
+#endif // QUIET_MOVE_PARTIAL_SORT
 
 #endif // !SORT_H
\ No newline at end of file
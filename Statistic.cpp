@@ -0,0 +1,104 @@
+// Statistic.cpp
+
+#include "stdafx.h"
+
+#include "Statistic.h"
+
+#include "Def.h"
+#include "Types.h"
+
+BOOL UseStatistic = FALSE;
+
+const char* StatisticName[STAT_COUNT] = {
+    "search",
+    "hash_probe",
+    "hash_hit",
+    "hash_cutoff",
+    "reverse_futility_pruning",
+    "razoring_try",
+    "razoring",
+    "null_move_try",
+    "null_move_pruning",
+    "probcut_try",
+    "probcut",
+    "iid",
+    "see_capture_move_pruning",
+    "futility_pruning",
+    "late_move_pruning",
+    "see_quiet_move_pruning",
+    "late_move_reduction",
+    "late_move_research",
+    "principal_research",
+    "check_extension",
+    "singular_try",
+    "singular_extension",
+    "cmh_extension",
+    "cutoff",
+    "first_move_cutoff",
+    "quiescence",
+    "quiescence_hash_probe",
+    "quiescence_hash_hit",
+    "quiescence_hash_cutoff",
+    "quiescence_stand_pat",
+    "quiescence_see_pruning",
+    "quiescence_cutoff",
+    "evaluate"
+};
+
+void ClearStatistic(StatisticItem* Statistic)
+{
+    memset(Statistic->Counter, 0, sizeof(Statistic->Counter));
+}
+
+void AddStatistic(StatisticItem* Total, const StatisticItem* Statistic)
+{
+    for (int Index = 0; Index < STAT_COUNT; ++Index) {
+        Total->Counter[Index] += Statistic->Counter[Index];
+    }
+}
+
+double StatisticRate(const U64 Count, const U64 Total)
+{
+    return (Total > 0ULL) ? (double)Count / (double)Total : 0.0;
+}
+
+void PrintStatistic(FILE* File, const StatisticItem* Statistic, const U64 Nodes, const U64 Time)
+{
+    const U64* Counter = Statistic->Counter;
+
+    fprintf(File, "{\n");
+
+    fprintf(File, "  \"nodes\": %llu,\n", Nodes);
+    fprintf(File, "  \"time\": %llu,\n", Time);
+
+    fprintf(File, "  \"hash_hit_rate\": %.4f,\n", StatisticRate(Counter[STAT_HASH_HIT] + Counter[STAT_QUIESCENCE_HASH_HIT], Counter[STAT_HASH_PROBE] + Counter[STAT_QUIESCENCE_HASH_PROBE]));
+    fprintf(File, "  \"first_move_cutoff_rate\": %.4f,\n", StatisticRate(Counter[STAT_FIRST_MOVE_CUTOFF], Counter[STAT_CUTOFF]));
+    fprintf(File, "  \"quiescence_rate\": %.4f,\n", StatisticRate(Counter[STAT_QUIESCENCE], Counter[STAT_SEARCH] + Counter[STAT_QUIESCENCE]));
+
+    fprintf(File, "  \"counters\": {\n");
+
+    for (int Index = 0; Index < STAT_COUNT; ++Index) {
+        fprintf(File, "    \"%s\": %llu%s\n", StatisticName[Index], Counter[Index], (Index < STAT_COUNT - 1 ? "," : ""));
+    }
+
+    fprintf(File, "  }\n");
+
+    fprintf(File, "}\n");
+}
+
+void SaveStatistic(const char* FileName, const StatisticItem* Statistic, const U64 Nodes, const U64 Time)
+{
+    FILE* File;
+
+    fopen_s(&File, FileName, "w");
+
+    if (File == NULL) { // File create (open) error
+        printf("File '%s' create (open) error!\n", FileName);
+
+        return;
+    }
+
+    PrintStatistic(File, Statistic, Nodes, Time);
+
+    fclose(File);
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+// Statistic.h
+
+#pragma once
+
+#ifndef STATISTIC_H
+#define STATISTIC_H
+
+#include "Def.h"
+#include "Types.h"
+
+// Search
+
+#define STAT_SEARCH                     0   // Search calls (depth > 0)
+#define STAT_HASH_PROBE                 1
+#define STAT_HASH_HIT                   2
+#define STAT_HASH_CUTOFF                3
+#define STAT_REVERSE_FUTILITY_PRUNING   4
+#define STAT_RAZORING_TRY               5
+#define STAT_RAZORING                   6
+#define STAT_NULL_MOVE_TRY              7
+#define STAT_NULL_MOVE_PRUNING          8
+#define STAT_PROBCUT_TRY                9   // Captures searched
+#define STAT_PROBCUT                    10
+#define STAT_IID                        11
+#define STAT_SEE_CAPTURE_MOVE_PRUNING   12
+#define STAT_FUTILITY_PRUNING           13
+#define STAT_LATE_MOVE_PRUNING          14
+#define STAT_SEE_QUIET_MOVE_PRUNING     15
+#define STAT_LATE_MOVE_REDUCTION        16
+#define STAT_LATE_MOVE_RESEARCH         17  // Reduced search failed high
+#define STAT_PRINCIPAL_RESEARCH         18  // Zero window search failed high
+#define STAT_CHECK_EXTENSION            19
+#define STAT_SINGULAR_TRY               20
+#define STAT_SINGULAR_EXTENSION         21
+#define STAT_CMH_EXTENSION              22
+#define STAT_CUTOFF                     23
+#define STAT_FIRST_MOVE_CUTOFF          24
+
+// Quiescence search
+
+#define STAT_QUIESCENCE                 25  // Quiescence search calls
+#define STAT_QUIESCENCE_HASH_PROBE      26
+#define STAT_QUIESCENCE_HASH_HIT        27
+#define STAT_QUIESCENCE_HASH_CUTOFF     28
+#define STAT_QUIESCENCE_STAND_PAT       29
+#define STAT_QUIESCENCE_SEE_PRUNING     30
+#define STAT_QUIESCENCE_CUTOFF          31
+
+// Evaluate
+
+#define STAT_EVALUATE                   32
+
+#define STAT_COUNT                      33
+
+// Near-zero cost if not used (one predictable branch)
+#define STAT_INC(Board, Index)          do { if (UseStatistic) ++(Board)->Statistic.Counter[(Index)]; } while (0)
+
+typedef struct {
+    _declspec(align(64)) U64 Counter[STAT_COUNT]; // Own cache lines (one item per thread board)
+} StatisticItem; // 320 bytes
+
+extern BOOL UseStatistic;
+
+void ClearStatistic(StatisticItem* Statistic);
+void AddStatistic(StatisticItem* Total, const StatisticItem* Statistic);
+
+void PrintStatistic(FILE* File, const StatisticItem* Statistic, const U64 Nodes, const U64 Time);
+void SaveStatistic(const char* FileName, const StatisticItem* Statistic, const U64 Nodes, const U64 Time);
+
+#endif // !STATISTIC_H
\ No newline at end of file
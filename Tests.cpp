@@ -7,8 +7,15 @@
 #include "Board.h"
 #include "Def.h"
 #include "Game.h"
+#include "Gen.h"
 #include "Hash.h"
+#include "Move.h"
 #include "NNUE2.h"
+#include "Perft.h"
+#include "SEE.h"
+#include "Search.h"
+#include "Statistic.h"
+#include "Tuning.h"
 #include "Types.h"
 #include "Utils.h"
 
@@ -459,13 +466,26 @@ void GeneratorTest1(void)
 
     char* ResultString;
 
-    // Cache not used
+    U64 PerftTimeStart;
+    U64 PerftTime;
+
+    int SavedThreads;
+
+    // Search cache not used
 
     InitHashTable(1);
 
-    // Threads not used
+    if (!InitPerftHashTable(PERFT_HASH_TABLE_SIZE)) {
+        return;
+    }
+
+    SavedThreads = omp_get_max_threads(); // Restored at the end
 
-    omp_set_num_threads(1);
+    omp_set_num_threads(MaxThreads);
+
+    printf("\n");
+
+    printf("Threads = %d Perft hash table size = %d Mb\n", MaxThreads, PERFT_HASH_TABLE_SIZE);
 
     for (int TestNumber = 0; TestNumber < GeneratorTestCount; ++TestNumber) {
         printf("\n");
@@ -480,7 +500,11 @@ void GeneratorTest1(void)
         printf("\n");
 
         for (int Depth = 1; Depth <= GeneratorTests[TestNumber].Depth; ++Depth) {
-            ResultNodes = CountLegalMoves(&CurrentBoard, Depth);
+            PerftTimeStart = Clock();
+
+            ResultNodes = ParallelPerft(&CurrentBoard, Depth);
+
+            PerftTime = Clock() - PerftTimeStart;
 
             if (GeneratorTests[TestNumber].Nodes[Depth - 1] == ResultNodes) {
                 ResultString = "PASSED";
@@ -489,9 +513,19 @@ void GeneratorTest1(void)
                 ResultString = "FAILED";
             }
 
-            printf("Depth = %2d Nodes = %10llu Result nodes = %10llu %s\n", Depth, GeneratorTests[TestNumber].Nodes[Depth - 1], ResultNodes, ResultString);
+            printf("Depth = %2d Nodes = %10llu Result nodes = %10llu %s Time = %6.2f sec.", Depth, GeneratorTests[TestNumber].Nodes[Depth - 1], ResultNodes, ResultString, (double)PerftTime / 1000.0);
+
+            if (PerftTime > 0ULL) {
+                printf(" NPS = %llu", 1000ULL * ResultNodes / PerftTime);
+            }
+
+            printf("\n");
         }
     }
+
+    FreePerftHashTable();
+
+    omp_set_num_threads(SavedThreads);
 }
 
 void GeneratorTest2(void)
@@ -500,13 +534,22 @@ void GeneratorTest2(void)
 
     U64 ResultNodes;
 
-    // Cache not used
+    U64 PerftTimeStart;
+    U64 PerftTime;
+
+    int SavedThreads;
+
+    // Search cache not used
 
     InitHashTable(1);
 
-    // Threads not used
+    if (!InitPerftHashTable(PERFT_HASH_TABLE_SIZE)) {
+        return;
+    }
+
+    SavedThreads = omp_get_max_threads(); // Restored at the end
 
-    omp_set_num_threads(1);
+    omp_set_num_threads(MaxThreads);
 
     printf("\n");
 
@@ -519,11 +562,29 @@ void GeneratorTest2(void)
 
     printf("\n");
 
+    printf("Threads = %d Perft hash table size = %d Mb\n", MaxThreads, PERFT_HASH_TABLE_SIZE);
+
+    printf("\n");
+
     for (int Depth = 1; Depth <= MaxDepth; ++Depth) {
-        ResultNodes = CountLegalMoves(&CurrentBoard, Depth);
+        PerftTimeStart = Clock();
+
+        ResultNodes = ParallelPerft(&CurrentBoard, Depth);
+
+        PerftTime = Clock() - PerftTimeStart;
+
+        printf("Depth = %2d Result nodes = %10llu Time = %6.2f sec.", Depth, ResultNodes, (double)PerftTime / 1000.0);
 
-        printf("Depth = %2d Result nodes = %10llu\n", Depth, ResultNodes);
+        if (PerftTime > 0ULL) {
+            printf(" NPS = %llu", 1000ULL * ResultNodes / PerftTime);
+        }
+
+        printf("\n");
     }
+
+    FreePerftHashTable();
+
+    omp_set_num_threads(SavedThreads);
 }
 
 void Tests(const char* Tests[], const int TestCount)
@@ -600,6 +661,1064 @@ void WinAtChessTest(void)
     Tests(WinAtChessTests, WinAtChessTestCount);
 }
 
+void ReadEpdOperation(const char* Line, const char* Operation, char* Value, const int ValueSize)
+{
+    const char* Part = strstr(Line, Operation);
+    char* ValuePart = Value;
+
+    if (Part != NULL) {
+        Part += strlen(Operation);
+
+        while (*Part == ' ' || *Part == '"') {
+            ++Part;
+        }
+
+        while (*Part != '\0' && *Part != ';' && *Part != '"' && *Part != '\r' && *Part != '\n' && ValuePart < Value + ValueSize - 1) {
+            *ValuePart++ = *Part++;
+        }
+    }
+
+    *ValuePart = '\0'; // Nul
+}
+
+int ReadEpdMoves(BoardItem* Board, const char* MoveStrings, int* Moves)
+{
+    char MoveString[16];
+
+    int MoveCount = 0;
+
+    int Length;
+
+    while (*MoveStrings != '\0' && MoveCount < EPD_MAX_MOVES) {
+        while (*MoveStrings == ' ') {
+            ++MoveStrings;
+        }
+
+        for (Length = 0; MoveStrings[Length] != '\0' && MoveStrings[Length] != ' '; ++Length);
+
+        if (Length > 0 && Length < (int)sizeof(MoveString)) {
+            memcpy(MoveString, MoveStrings, Length);
+            MoveString[Length] = '\0'; // Nul
+
+            Moves[MoveCount] = ParseMove(Board, MoveString);
+
+            if (Moves[MoveCount]) {
+                ++MoveCount;
+            }
+        }
+
+        MoveStrings += Length;
+    }
+
+    return MoveCount;
+}
+
+void EpdTestDepthDone(const BoardItem* Board, const int Depth, const int Score, void* Data)
+{
+    EpdSearchItem* EpdSearch = (EpdSearchItem*)Data;
+    EpdTestItem* Test = EpdSearch->Test;
+
+    int Move = Board->BestMovesRoot[0].Move;
+    BOOL Solved;
+
+    Test->Score = Score;
+
+    Test->Depth = Depth;
+    Test->Nodes = Board->Nodes;
+    Test->Time = Clock() - EpdSearch->TimeStart;
+
+    if (!Move) { // No legal moves
+        return;
+    }
+
+    // Best move is one of "bm" moves and none of "am" moves
+
+    if (EpdSearch->BestMoveCount > 0) {
+        Solved = FALSE;
+
+        for (int MoveNumber = 0; MoveNumber < EpdSearch->BestMoveCount; ++MoveNumber) {
+            if (EpdSearch->BestMoves[MoveNumber] == Move) {
+                Solved = TRUE;
+
+                break; // for
+            }
+        }
+    }
+    else {
+        Solved = (EpdSearch->AvoidMoveCount > 0);
+    }
+
+    for (int MoveNumber = 0; MoveNumber < EpdSearch->AvoidMoveCount; ++MoveNumber) {
+        if (EpdSearch->AvoidMoves[MoveNumber] == Move) {
+            Solved = FALSE;
+
+            break; // for
+        }
+    }
+
+    if (Solved && !Test->Solved) { // Time to solution
+        Test->SolvedDepth = Depth;
+        Test->SolvedNodes = Test->Nodes;
+        Test->SolvedTime = Test->Time;
+    }
+
+    Test->Solved = Solved;
+}
+
+void EpdTestPosition(BoardItem* Board, HashStoreItem* Store, EpdTestItem* Test, const U64 SearchNodes, const U64 SearchTime)
+{
+    EpdSearchItem EpdSearch;
+
+    BOOL InCheck;
+
+    SetFen(Board, Test->Fen);
+
+    ClearHashStore(Store);
+
+    Board->HashStore = Store; // Own hash table of the thread (SetFen sets the shared hash table)
+
+    EpdSearch.Test = Test;
+
+    EpdSearch.BestMoveCount = ReadEpdMoves(Board, Test->BestMoves, EpdSearch.BestMoves);
+    EpdSearch.AvoidMoveCount = ReadEpdMoves(Board, Test->AvoidMoves, EpdSearch.AvoidMoves);
+
+    EpdSearch.TimeStart = Clock();
+
+    InCheck = IsInCheck(Board, Board->CurrentColor);
+
+    SearchIterative(Board, MAX_PLY - 1, SearchNodes, SearchTime, InCheck, EpdTestDepthDone, &EpdSearch);
+
+    Test->Nodes = Board->Nodes; // With the not completed depth
+    Test->Time = Clock() - EpdSearch.TimeStart;
+
+    if (Board->BestMovesRoot[0].Move) {
+        NotateMove(Board, Board->BestMovesRoot[0], Test->Move);
+    }
+    else { // No legal moves
+        strcpy_s(Test->Move, sizeof(Test->Move), "none");
+    }
+
+    if (!Test->Solved) {
+        Test->SolvedDepth = 0;
+        Test->SolvedNodes = 0ULL;
+        Test->SolvedTime = 0ULL;
+    }
+}
+
+void PrintJsonString(FILE* File, const char* String)
+{
+    fputc('"', File);
+
+    while (*String != '\0') {
+        if (*String == '"' || *String == '\\') {
+            fputc('\\', File);
+        }
+
+        fputc(*String++, File);
+    }
+
+    fputc('"', File);
+}
+
+void EpdTest(const char* FileInName, const char* FileOutName, const U64 SearchNodes, const U64 SearchTime)
+{
+    FILE* FileIn;
+    FILE* FileOut;
+
+    char Line[1024];
+    char Fen[MAX_FEN_LENGTH];
+
+    EpdTestItem* Tests = NULL;
+    EpdTestItem* NewTests;
+
+    int TestCount = 0;
+    int MaxTestCount = 0;
+
+    int TestDoneCount = 0;
+    int TestPassedCount = 0;
+
+    U64 TotalNodes = 0ULL;
+
+    U64 TestTimeStart;
+    U64 TestTime;
+
+    EpdTestItem* Test;
+
+    BoardItem* ThreadBoard;
+
+    HashStoreItem ThreadHashStore;
+
+    int SavedThreads;
+
+    printf("\n");
+
+    printf("EPD test...\n");
+
+    if (SearchNodes == 0ULL && SearchTime == 0ULL) { // No limits
+        printf("Nodes or time per position required!\n");
+
+        return;
+    }
+
+    fopen_s(&FileIn, FileInName, "r");
+
+    if (FileIn == NULL) { // File open error
+        printf("File '%s' open error!\n", FileInName);
+
+        return;
+    }
+
+    // Read positions
+
+    while (fgets(Line, sizeof(Line), FileIn) != NULL) {
+        if (!ReadPositionFen(Line, Fen)) { // Empty string or comment
+            continue; // Next string
+        }
+
+        if (TestCount >= MaxTestCount) {
+            NewTests = (EpdTestItem*)realloc(Tests, (MaxTestCount + 1024) * sizeof(EpdTestItem));
+
+            if (NewTests == NULL) { // Allocate memory error
+                printf("Allocate memory to tests error!\n");
+
+                free(Tests);
+
+                fclose(FileIn);
+
+                return;
+            }
+
+            Tests = NewTests;
+            MaxTestCount += 1024;
+        }
+
+        Test = &Tests[TestCount++];
+
+        memset(Test, 0, sizeof(EpdTestItem));
+
+        strcpy_s(Test->Fen, sizeof(Test->Fen), Fen);
+
+        ReadEpdOperation(Line, " id ", Test->Id, sizeof(Test->Id));
+        ReadEpdOperation(Line, " bm ", Test->BestMoves, sizeof(Test->BestMoves));
+        ReadEpdOperation(Line, " am ", Test->AvoidMoves, sizeof(Test->AvoidMoves));
+    }
+
+    fclose(FileIn);
+
+    if (TestCount == 0) {
+        printf("No positions in file '%s'!\n", FileInName);
+
+        free(Tests);
+
+        return;
+    }
+
+    fopen_s(&FileOut, FileOutName, "w");
+
+    if (FileOut == NULL) { // File create (open) error
+        printf("File '%s' create (open) error!\n", FileOutName);
+
+        free(Tests);
+
+        return;
+    }
+
+    // Search settings (positions are limited by nodes or time, global time is not used; own hash table of the thread: the positions do not depend on each other)
+
+    TimeStart = Clock();
+    TimeStop = ULLONG_MAX;
+
+    MaxNodes = 0ULL; // Global node limit is not used (one search per thread)
+
+    CompletedDepth = 0;
+
+    StopSearch = FALSE;
+
+    SavedThreads = omp_get_max_threads(); // Restored at the end
+
+    omp_set_num_threads(MaxThreads);
+
+    printf("\n");
+
+    printf("Positions = %d Threads = %d (one position per thread)\n", TestCount, MaxThreads);
+
+    if (SearchNodes > 0ULL) {
+        printf("Nodes per position = %llu\n", SearchNodes);
+    }
+
+    if (SearchTime > 0ULL) {
+        printf("Time per position = %llu ms\n", SearchTime);
+    }
+
+    printf("\n");
+
+    TestTimeStart = Clock();
+
+#pragma omp parallel private(ThreadBoard, ThreadHashStore)
+    {
+        ThreadBoard = &ThreadBoardList[omp_get_thread_num()];
+
+        InitHashStore(&ThreadHashStore, EPD_HASH_TABLE_SIZE); // Own hash table of the thread (NULL items if allocate memory error)
+
+#pragma omp for schedule(dynamic, 1)
+        for (int TestNumber = 0; TestNumber < TestCount; ++TestNumber) {
+            if (ThreadHashStore.Item == NULL) {
+                continue; // Next position
+            }
+
+            EpdTestPosition(ThreadBoard, &ThreadHashStore, &Tests[TestNumber], SearchNodes, SearchTime);
+
+#pragma omp critical
+            {
+                ++TestDoneCount;
+
+                printf("%d/%d %s %s %s (depth %d nodes %llu time %llu ms)\n", TestDoneCount, TestCount, (Tests[TestNumber].Id[0] ? Tests[TestNumber].Id : Tests[TestNumber].Fen), Tests[TestNumber].Move, (Tests[TestNumber].Solved ? "PASSED" : "FAILED"), Tests[TestNumber].Depth, Tests[TestNumber].Nodes, Tests[TestNumber].Time);
+            }
+        }
+
+        FreeHashStore(&ThreadHashStore);
+
+        ThreadBoard->HashStore = &HashStore; // Own hash table is freed
+    } // pragma omp parallel
+
+    TestTime = Clock() - TestTimeStart;
+
+    omp_set_num_threads(SavedThreads);
+
+    for (int TestNumber = 0; TestNumber < TestCount; ++TestNumber) {
+        if (Tests[TestNumber].Solved) {
+            ++TestPassedCount;
+        }
+
+        TotalNodes += Tests[TestNumber].Nodes;
+    }
+
+    // Results (JSON)
+
+    fprintf(FileOut, "{\n");
+    fprintf(FileOut, "  \"positions\": %d,\n", TestCount);
+    fprintf(FileOut, "  \"solved\": %d,\n", TestPassedCount);
+    fprintf(FileOut, "  \"threads\": %d,\n", MaxThreads);
+    fprintf(FileOut, "  \"node_limit\": %llu,\n", SearchNodes);
+    fprintf(FileOut, "  \"time_limit\": %llu,\n", SearchTime);
+    fprintf(FileOut, "  \"nodes\": %llu,\n", TotalNodes);
+    fprintf(FileOut, "  \"time\": %llu,\n", TestTime);
+    fprintf(FileOut, "  \"results\": [\n");
+
+    for (int TestNumber = 0; TestNumber < TestCount; ++TestNumber) {
+        Test = &Tests[TestNumber];
+
+        fprintf(FileOut, "    {\"id\": ");
+        PrintJsonString(FileOut, Test->Id);
+        fprintf(FileOut, ", \"fen\": ");
+        PrintJsonString(FileOut, Test->Fen);
+        fprintf(FileOut, ", \"bm\": ");
+        PrintJsonString(FileOut, Test->BestMoves);
+        fprintf(FileOut, ", \"am\": ");
+        PrintJsonString(FileOut, Test->AvoidMoves);
+        fprintf(FileOut, ", \"move\": ");
+        PrintJsonString(FileOut, Test->Move);
+
+        fprintf(FileOut, ", \"score\": %d, \"solved\": %s, \"depth\": %d, \"nodes\": %llu, \"time\": %llu", Test->Score, (Test->Solved ? "true" : "false"), Test->Depth, Test->Nodes, Test->Time);
+        fprintf(FileOut, ", \"solved_depth\": %d, \"solved_nodes\": %llu, \"solved_time\": %llu}%s\n", Test->SolvedDepth, Test->SolvedNodes, Test->SolvedTime, (TestNumber < TestCount - 1 ? "," : ""));
+    }
+
+    fprintf(FileOut, "  ]\n");
+    fprintf(FileOut, "}\n");
+
+    fclose(FileOut);
+
+    free(Tests);
+
+    printf("\n");
+
+    printf("Tests %d Tests passed %d (%d%%) Time = %.2f sec.\n", TestCount, TestPassedCount, 100 * TestPassedCount / TestCount, (double)TestTime / 1000.0);
+
+    printf("\n");
+
+    printf("EPD test...DONE\n");
+}
+
+void Bench(const int Depth, const int Threads, const int HashSizeInMb)
+{
+    U64 TotalNodes = 0ULL;
+    U64 TotalTestTime = 0ULL;
+
+    // Search settings (fixed depth, book not used, time is not used)
+
+    MaxDepth = Depth;
+
+    MaxTime = (U64)MAX_TIME * 1000ULL;
+
+    MaxNodes = 0ULL;
+
+    TimeForMove = 0ULL;
+
+    TargetTime = 0ULL;
+
+    InitHashTable(HashSizeInMb);
+
+    if (!IsHashTableInitialized()) {
+        printf("Hash table not initialized!\n");
+
+        return;
+    }
+
+    omp_set_num_threads(Threads);
+
+    printf("\n");
+
+    printf("Bench: depth = %d threads = %d hash table size = %d Mb positions = %d\n", Depth, Threads, HashSizeInMb, BratkoKopecTestCount);
+
+    PrintMode = PRINT_MODE_TESTS;
+
+    for (int TestNumber = 0; TestNumber < BratkoKopecTestCount; ++TestNumber) {
+        printf("\n");
+
+        printf("Position %d/%d FEN = %s\n", TestNumber + 1, BratkoKopecTestCount, BratkoKopecTests[TestNumber * 2]);
+
+        // Prepare new game (the same start state for every position)
+
+        SetFen(&CurrentBoard, BratkoKopecTests[TestNumber * 2]);
+
+        ClearHashTable();
+
+        ComputerMove();
+
+        TotalNodes += CurrentBoard.Nodes;
+        TotalTestTime += TotalTime;
+    }
+
+    PrintMode = PRINT_MODE_NORMAL;
+
+    printf("\n");
+
+    printf("Total nodes %llu Total time %.2f\n", TotalNodes, (double)TotalTestTime / 1000.0);
+
+    if (TotalTestTime > 0ULL) {
+        printf("NPS %llu\n", 1000ULL * TotalNodes / TotalTestTime);
+    }
+
+    printf("\n");
+
+    printf("Signature %llu%s\n", TotalNodes, (Threads > 1) ? " (not reproducible with threads > 1)" : "");
+}
+
+volatile U64 KernelSink; // Kernel results (the calls can not be removed by the compiler)
+
+int KernelGenerateAllMoves(KernelPositionItem* Position)
+{
+    int GenMoveCount = 0;
+    MoveListItem MoveList;
+
+    GenerateAllMoves(&Position->Board, NULL, &MoveList, &GenMoveCount);
+
+    KernelSink += (U64)GenMoveCount;
+
+    return 1;
+}
+
+int KernelGenerateCaptureMoves(KernelPositionItem* Position)
+{
+    int GenMoveCount = 0;
+    MoveListItem MoveList;
+
+    GenerateCaptureMoves(&Position->Board, NULL, &MoveList, &GenMoveCount);
+
+    KernelSink += (U64)GenMoveCount;
+
+    return 1;
+}
+
+int KernelMakeUnmakeMove(KernelPositionItem* Position)
+{
+    U64 Hash = 0ULL;
+
+    for (int MoveNumber = 0; MoveNumber < Position->LegalMoveCount; ++MoveNumber) {
+        MakeMove(&Position->Board, Position->LegalMoveList[MoveNumber]);
+
+        Hash ^= Position->Board.Hash;
+
+        UnmakeMove(&Position->Board);
+    }
+
+    KernelSink += Hash;
+
+    return Position->LegalMoveCount;
+}
+
+int KernelAccumulator(KernelPositionItem* Position) // Sub/add pair (the accumulator is restored)
+{
+    BoardItem* Board = &Position->Board;
+
+    int Operations = 0;
+
+    for (int Square = 0; Square < 64; ++Square) {
+        if (Board->Pieces[Square] != NO_PIECE && PIECE_TYPE(Board->Pieces[Square]) != KING) {
+            AccumulatorSub(Board, Square, Board->Pieces[Square]);
+            AccumulatorAdd(Board, Square, Board->Pieces[Square]);
+
+            ++Operations;
+        }
+    }
+
+    KernelSink += (U64)Board->Accumulator.Accumulator[WHITE][0];
+
+    return Operations;
+}
+
+int KernelOutputLayer(KernelPositionItem* Position)
+{
+    KernelSink += (U64)OutputLayer(&Position->Board);
+
+    return 1;
+}
+
+int KernelSEE_GE(KernelPositionItem* Position)
+{
+    int Result = 0;
+
+    for (int MoveNumber = 0; MoveNumber < Position->CaptureMoveCount; ++MoveNumber) {
+        Result += SEE_GE(&Position->Board, Position->CaptureMoveList[MoveNumber].Type, Position->CaptureMoveList[MoveNumber].Move, 0, NULL);
+    }
+
+    KernelSink += (U64)Result;
+
+    return Position->CaptureMoveCount;
+}
+
+#ifdef BAD_CAPTURE_LAST
+int KernelSEE(KernelPositionItem* Position)
+{
+    int Result = 0;
+
+    for (int MoveNumber = 0; MoveNumber < Position->CaptureMoveCount; ++MoveNumber) {
+        Result += SEE(&Position->Board, Position->CaptureMoveList[MoveNumber].Type, Position->CaptureMoveList[MoveNumber].Move);
+    }
+
+    KernelSink += (U64)Result;
+
+    return Position->CaptureMoveCount;
+}
+#endif // BAD_CAPTURE_LAST
+
+int KernelIsSquareAttacked(KernelPositionItem* Position)
+{
+    int Result = 0;
+
+    for (int Square = 0; Square < 64; ++Square) {
+        Result += IsSquareAttacked(&Position->Board, Square, Position->Board.CurrentColor);
+    }
+
+    KernelSink += (U64)Result;
+
+    return 64;
+}
+
+int KernelSaveHash(KernelPositionItem* Position)
+{
+    for (int Index = 0; Index < 16; ++Index) {
+        SaveHash(&HashStore, Position->Board.Hash + (U64)Index * 0x9E3779B97F4A7C15ULL, 1, 0, Index, Index, 0, HASH_EXACT);
+    }
+
+    return 16;
+}
+
+int KernelLoadHash(KernelPositionItem* Position)
+{
+    int HashScore = 0;
+    int HashStaticScore = 0;
+    int HashMove = 0;
+    int HashDepth = -MAX_PLY;
+    int HashFlag = 0;
+
+    int Result = 0;
+
+    for (int Index = 0; Index < 16; ++Index) {
+        LoadHash(&HashStore, Position->Board.Hash + (U64)Index * 0x9E3779B97F4A7C15ULL, &HashDepth, 0, &HashScore, &HashStaticScore, &HashMove, &HashFlag);
+
+        Result += HashScore;
+    }
+
+    KernelSink += (U64)Result;
+
+    return 16;
+}
+
+int KernelPositionRepeat1(KernelPositionItem* Position)
+{
+    KernelSink += (U64)PositionRepeat1(&Position->Board);
+
+    return 1;
+}
+
+void KernelBenchmark(const char* BaselineFileName, const BOOL SaveBaseline)
+{
+    KernelItem Kernels[] = {
+        { "GenerateAllMoves", KernelGenerateAllMoves, 0.0, 0.0, 0.0 },
+        { "GenerateCaptureMoves", KernelGenerateCaptureMoves, 0.0, 0.0, 0.0 },
+        { "MakeMove+UnmakeMove", KernelMakeUnmakeMove, 0.0, 0.0, 0.0 },
+        { "AccumulatorSub+Add", KernelAccumulator, 0.0, 0.0, 0.0 },
+        { "OutputLayer", KernelOutputLayer, 0.0, 0.0, 0.0 },
+        { "SEE_GE", KernelSEE_GE, 0.0, 0.0, 0.0 },
+#ifdef BAD_CAPTURE_LAST
+        { "SEE", KernelSEE, 0.0, 0.0, 0.0 },
+#endif // BAD_CAPTURE_LAST
+        { "IsSquareAttacked", KernelIsSquareAttacked, 0.0, 0.0, 0.0 },
+        { "SaveHash", KernelSaveHash, 0.0, 0.0, 0.0 },
+        { "LoadHash", KernelLoadHash, 0.0, 0.0, 0.0 },
+        { "PositionRepeat1", KernelPositionRepeat1, 0.0, 0.0, 0.0 }
+    };
+
+    const int KernelCount = sizeof(Kernels) / sizeof(KernelItem);
+
+    const int PositionCount = BratkoKopecTestCount + WinAtChessTestCount;
+
+    KernelPositionItem* Positions;
+    KernelPositionItem* Position;
+
+    BoardItem* Board;
+
+    MoveItem LegalMoveList[MAX_GEN_MOVES];
+    int LegalMoveCount;
+
+    int MoveNumber;
+
+    KernelItem* Kernel;
+
+    LARGE_INTEGER RunTimeStart;
+    LARGE_INTEGER RunTimeStop;
+
+    LARGE_INTEGER Frequency;
+
+    U64 CyclesStart;
+    U64 Cycles;
+
+    U64 Operations;
+    int PassOperations;
+
+    double RunTime[KERNEL_RUNS];
+    double RunCycles;
+
+    FILE* File;
+
+    char Line[256];
+    char Name[64];
+    char* Part;
+
+    double BaselineTime;
+    double BaselineDeviation;
+    double Delta;
+
+    BOOL BaselineFound;
+
+    int Regressions = 0;
+
+    if (!IsHashTableInitialized()) {
+        printf("Hash table not initialized!\n");
+
+        return;
+    }
+
+    Positions = (KernelPositionItem*)_aligned_malloc(PositionCount * sizeof(KernelPositionItem), 64); // The accumulator is aligned (AVX2)
+
+    if (Positions == NULL) { // Allocate memory error
+        printf("Allocate memory to kernel positions error!\n");
+
+        return;
+    }
+
+    memset(Positions, 0, PositionCount * sizeof(KernelPositionItem));
+
+    QueryPerformanceFrequency(&Frequency);
+
+    // Positions: reversible moves (history for the repetition check), legal moves and capture moves
+
+    for (int PositionNumber = 0; PositionNumber < PositionCount; ++PositionNumber) {
+        Position = &Positions[PositionNumber];
+        Board = &Position->Board;
+
+        if (PositionNumber < BratkoKopecTestCount) {
+            SetFen(Board, BratkoKopecTests[PositionNumber * 2]);
+        }
+        else {
+            SetFen(Board, WinAtChessTests[(PositionNumber - BratkoKopecTestCount) * 2]);
+        }
+
+        for (int Ply = 0; Ply < KERNEL_HISTORY_PLY; ++Ply) {
+            LegalMoveCount = 0;
+            GenerateAllLegalMoves(Board, NULL, LegalMoveList, &LegalMoveCount);
+
+            for (MoveNumber = 0; MoveNumber < LegalMoveCount; ++MoveNumber) {
+                if (!(LegalMoveList[MoveNumber].Type & (MOVE_PAWN | MOVE_PAWN_2 | MOVE_PAWN_PASSANT | MOVE_PAWN_PROMOTE | MOVE_CAPTURE | MOVE_CASTLE_KING | MOVE_CASTLE_QUEEN))) { // Reversible move
+                    break; // for
+                }
+            }
+
+            if (MoveNumber == LegalMoveCount) { // No reversible moves
+                break; // for (ply)
+            }
+
+            MakeMove(Board, LegalMoveList[MoveNumber]);
+        }
+
+        Position->LegalMoveCount = 0;
+        GenerateAllLegalMoves(Board, NULL, Position->LegalMoveList, &Position->LegalMoveCount);
+
+        Position->CaptureMoveCount = 0;
+
+        for (MoveNumber = 0; MoveNumber < Position->LegalMoveCount; ++MoveNumber) {
+            if (Position->LegalMoveList[MoveNumber].Type & MOVE_CAPTURE) {
+                Position->CaptureMoveList[Position->CaptureMoveCount++] = Position->LegalMoveList[MoveNumber];
+            }
+        }
+    }
+
+    printf("\n");
+
+    printf("Kernel benchmark: positions = %d runs = %d operations per run = %d\n", PositionCount, KERNEL_RUNS, KERNEL_MIN_OPERATIONS);
+
+    for (int KernelNumber = 0; KernelNumber < KernelCount; ++KernelNumber) {
+        Kernel = &Kernels[KernelNumber];
+
+        RunCycles = 0.0;
+
+        for (int Run = 0; Run <= KERNEL_RUNS; ++Run) { // Run 0 = warm-up (caches, branch predictors)
+            Operations = 0ULL;
+
+            QueryPerformanceCounter(&RunTimeStart);
+
+            CyclesStart = __rdtsc();
+
+            do {
+                PassOperations = 0;
+
+                for (int PositionNumber = 0; PositionNumber < PositionCount; ++PositionNumber) {
+                    PassOperations += Kernel->Function(&Positions[PositionNumber]);
+                }
+
+                Operations += (U64)PassOperations;
+            } while (PassOperations > 0 && Operations < (U64)KERNEL_MIN_OPERATIONS);
+
+            Cycles = __rdtsc() - CyclesStart;
+
+            QueryPerformanceCounter(&RunTimeStop);
+
+            if (Run > 0 && Operations > 0ULL) {
+                RunTime[Run - 1] = 1000000000.0 * (double)(RunTimeStop.QuadPart - RunTimeStart.QuadPart) / (double)Frequency.QuadPart / (double)Operations;
+
+                RunCycles += (double)Cycles / (double)Operations;
+            }
+            else if (Run > 0) {
+                RunTime[Run - 1] = 0.0;
+            }
+        }
+
+        Kernel->Time = 0.0;
+
+        for (int Run = 0; Run < KERNEL_RUNS; ++Run) {
+            Kernel->Time += RunTime[Run];
+        }
+
+        Kernel->Time /= KERNEL_RUNS;
+
+        Kernel->Deviation = 0.0;
+
+        for (int Run = 0; Run < KERNEL_RUNS; ++Run) {
+            Kernel->Deviation += (RunTime[Run] - Kernel->Time) * (RunTime[Run] - Kernel->Time);
+        }
+
+        Kernel->Deviation = sqrt(Kernel->Deviation / (KERNEL_RUNS - 1));
+
+        Kernel->Cycles = RunCycles / KERNEL_RUNS;
+    }
+
+    _aligned_free(Positions);
+
+    // Results (and the baseline)
+
+    fopen_s(&File, BaselineFileName, "r");
+
+    if (File == NULL && !SaveBaseline) {
+        printf("\n");
+
+        printf("Baseline file '%s' not found\n", BaselineFileName);
+    }
+
+    printf("\n");
+
+    printf("%-24s %10s %10s %10s %10s %9s\n", "Kernel", "ns/op", "Deviation", "Cycles/op", "Baseline", "Delta");
+
+    for (int KernelNumber = 0; KernelNumber < KernelCount; ++KernelNumber) {
+        Kernel = &Kernels[KernelNumber];
+
+        printf("%-24s %10.2f %10.2f %10.1f", Kernel->Name, Kernel->Time, Kernel->Deviation, Kernel->Cycles);
+
+        BaselineFound = FALSE;
+
+        BaselineTime = 0.0;
+        BaselineDeviation = 0.0;
+
+        if (File != NULL) {
+            rewind(File);
+
+            while (fgets(Line, sizeof(Line), File) != NULL) { // Line: name ns/op deviation cycles/op
+                if (Line[0] == '#') { // Comment
+                    continue; // Next line
+                }
+
+                Part = Line;
+
+                for (int Index = 0; Index < (int)sizeof(Name) - 1 && *Part != ' ' && *Part != '\0'; ++Index) {
+                    Name[Index] = *Part++;
+                    Name[Index + 1] = '\0';
+                }
+
+                if (Part != Line && strcmp(Name, Kernel->Name) == 0) {
+                    BaselineTime = strtod(Part, &Part);
+                    BaselineDeviation = strtod(Part, NULL);
+
+                    BaselineFound = (BaselineTime > 0.0);
+
+                    break; // while
+                }
+            }
+        }
+
+        if (BaselineFound) {
+            Delta = 100.0 * (Kernel->Time - BaselineTime) / BaselineTime;
+
+            printf(" %10.2f %+8.2f%%", BaselineTime, Delta);
+
+            if (Delta > KERNEL_REGRESSION && Kernel->Time - BaselineTime > Kernel->Deviation + BaselineDeviation) { // Slower than the noise of both runs
+                printf(" SLOWER");
+
+                ++Regressions;
+            }
+        }
+
+        printf("\n");
+    }
+
+    if (File != NULL) {
+        fclose(File);
+
+        printf("\n");
+
+        printf("Regressions (> %.0f%% slower than baseline '%s') %d\n", KERNEL_REGRESSION, BaselineFileName, Regressions);
+    }
+
+    if (SaveBaseline) {
+        fopen_s(&File, BaselineFileName, "w");
+
+        if (File == NULL) { // File create (open) error
+            printf("File '%s' create (open) error!\n", BaselineFileName);
+
+            return;
+        }
+
+        fprintf(File, "# %s %s kernel benchmark baseline: name ns/op deviation cycles/op\n", PROGRAM_NAME, PROGRAM_VERSION);
+
+        for (int KernelNumber = 0; KernelNumber < KernelCount; ++KernelNumber) {
+            fprintf(File, "%s %.2f %.2f %.1f\n", Kernels[KernelNumber].Name, Kernels[KernelNumber].Time, Kernels[KernelNumber].Deviation, Kernels[KernelNumber].Cycles);
+        }
+
+        fclose(File);
+
+        printf("\n");
+
+        printf("Baseline saved to file '%s'\n", BaselineFileName);
+    }
+}
+
+void ScalingTest(const int Depth, const int HashSizeInMb, const char* FileOutName)
+{
+    DepthInfoItem* Reference; // [BratkoKopecTestCount][MAX_PLY + 1] (one thread)
+    DepthInfoItem* Info;
+
+    int ThreadCount = 0;
+    int ThreadList[MAX_THREADS];
+
+    int Threads;
+
+    int LastDepth;
+
+    BOOL Agree;
+
+    U64 TotalNodes[MAX_THREADS];
+    U64 TotalTestTime[MAX_THREADS];
+    U64 TotalHashProbes[MAX_THREADS];
+    U64 TotalHashHits[MAX_THREADS];
+
+    int AgreeCount[MAX_THREADS];
+
+    U64 Nps;
+    U64 ReferenceNps;
+
+    BOOL SaveUseStatistic = UseStatistic;
+
+    FILE* FileOut;
+
+    // Threads: 1, 2, 4, ..., max. threads
+
+    for (Threads = 1; Threads < MaxThreads; Threads *= 2) {
+        ThreadList[ThreadCount++] = Threads;
+    }
+
+    ThreadList[ThreadCount++] = MaxThreads;
+
+    // Search settings (fixed depth, book not used, time is not used)
+
+    MaxDepth = Depth;
+
+    MaxTime = (U64)MAX_TIME * 1000ULL;
+
+    MaxNodes = 0ULL;
+
+    TimeForMove = 0ULL;
+
+    TargetTime = 0ULL;
+
+    InitHashTable(HashSizeInMb);
+
+    if (!IsHashTableInitialized()) {
+        printf("Hash table not initialized!\n");
+
+        return;
+    }
+
+    Reference = (DepthInfoItem*)calloc(BratkoKopecTestCount * (MAX_PLY + 1), sizeof(DepthInfoItem));
+
+    if (Reference == NULL) { // Allocate memory error
+        printf("Allocate memory to scaling test error!\n");
+
+        return;
+    }
+
+    fopen_s(&FileOut, FileOutName, "w");
+
+    if (FileOut == NULL) { // File create (open) error
+        printf("File '%s' create (open) error!\n", FileOutName);
+
+        free(Reference);
+
+        return;
+    }
+
+    fprintf(FileOut, "threads,position,depth,time,nodes,nps,hash_hit_rate,move,agree\n");
+
+    UseStatistic = TRUE; // Hash hits
+
+    PrintMode = PRINT_MODE_TESTS;
+
+    printf("\n");
+
+    printf("Scaling test: depth = %d hash table size = %d Mb positions = %d threads = %d\n", Depth, HashSizeInMb, BratkoKopecTestCount, MaxThreads);
+
+    for (int ThreadNumber = 0; ThreadNumber < ThreadCount; ++ThreadNumber) {
+        Threads = ThreadList[ThreadNumber];
+
+        omp_set_num_threads(Threads);
+
+        TotalNodes[ThreadNumber] = 0ULL;
+        TotalTestTime[ThreadNumber] = 0ULL;
+        TotalHashProbes[ThreadNumber] = 0ULL;
+        TotalHashHits[ThreadNumber] = 0ULL;
+
+        AgreeCount[ThreadNumber] = 0;
+
+        for (int TestNumber = 0; TestNumber < BratkoKopecTestCount; ++TestNumber) {
+            printf("\n");
+
+            printf("Threads %d Position %d/%d FEN = %s\n", Threads, TestNumber + 1, BratkoKopecTestCount, BratkoKopecTests[TestNumber * 2]);
+
+            // Prepare new game (the same start state for every position and threads)
+
+            SetFen(&CurrentBoard, BratkoKopecTests[TestNumber * 2]);
+
+            ClearHashTable();
+
+            memset(DepthInfo, 0, sizeof(DepthInfo));
+
+            ComputerMove();
+
+            LastDepth = CompletedDepth;
+
+            Info = &Reference[TestNumber * (MAX_PLY + 1)];
+
+            if (Threads == 1) {
+                memcpy(Info, DepthInfo, sizeof(DepthInfo));
+            }
+
+            for (int InfoDepth = 1; InfoDepth <= LastDepth; ++InfoDepth) {
+                Agree = (DepthInfo[InfoDepth].Move == Info[InfoDepth].Move);
+
+                fprintf(FileOut, "%d,%d,%d,%llu,%llu,%llu,%.4f,%s%s", Threads, TestNumber + 1, InfoDepth, DepthInfo[InfoDepth].Time, DepthInfo[InfoDepth].Nodes, (DepthInfo[InfoDepth].Time > 0ULL) ? 1000ULL * DepthInfo[InfoDepth].Nodes / DepthInfo[InfoDepth].Time : 0ULL, (DepthInfo[InfoDepth].HashProbes > 0ULL) ? (double)DepthInfo[InfoDepth].HashHits / (double)DepthInfo[InfoDepth].HashProbes : 0.0, BoardName[MOVE_FROM(DepthInfo[InfoDepth].Move)], BoardName[MOVE_TO(DepthInfo[InfoDepth].Move)]);
+
+                if (MOVE_PROMOTE_PIECE_TYPE(DepthInfo[InfoDepth].Move)) {
+                    fprintf(FileOut, "%c", PiecesCharBlack[MOVE_PROMOTE_PIECE_TYPE(DepthInfo[InfoDepth].Move)]);
+                }
+
+                fprintf(FileOut, ",%d\n", Agree);
+            }
+
+            // Final move (the last completed depth)
+
+            if (LastDepth > 0) {
+                TotalNodes[ThreadNumber] += DepthInfo[LastDepth].Nodes;
+                TotalTestTime[ThreadNumber] += DepthInfo[LastDepth].Time;
+
+                TotalHashProbes[ThreadNumber] += DepthInfo[LastDepth].HashProbes;
+                TotalHashHits[ThreadNumber] += DepthInfo[LastDepth].HashHits;
+
+                if (DepthInfo[LastDepth].Move == Info[LastDepth].Move) {
+                    ++AgreeCount[ThreadNumber];
+                }
+            }
+        }
+    }
+
+    PrintMode = PRINT_MODE_NORMAL;
+
+    UseStatistic = SaveUseStatistic;
+
+    fclose(FileOut);
+
+    free(Reference);
+
+    // Summary (the last completed depth; speedup = time to depth, nodes/1 = search overhead (duplicate nodes))
+
+    printf("\n");
+
+    printf("Scaling test: depth = %d hash table size = %d Mb positions = %d\n", Depth, HashSizeInMb, BratkoKopecTestCount);
+
+    printf("\n");
+
+    printf("%7s %12s %10s %8s %12s %8s %8s %10s %8s\n", "Threads", "Nodes", "Time", "Speedup", "NPS", "Scaling", "Nodes/1", "Hash hits", "Agree");
+
+    ReferenceNps = (TotalTestTime[0] > 0ULL) ? 1000ULL * TotalNodes[0] / TotalTestTime[0] : 0ULL;
+
+    for (int ThreadNumber = 0; ThreadNumber < ThreadCount; ++ThreadNumber) {
+        Nps = (TotalTestTime[ThreadNumber] > 0ULL) ? 1000ULL * TotalNodes[ThreadNumber] / TotalTestTime[ThreadNumber] : 0ULL;
+
+        printf("%7d %12llu %10.2f", ThreadList[ThreadNumber], TotalNodes[ThreadNumber], (double)TotalTestTime[ThreadNumber] / 1000.0);
+
+        printf(" %8.2f", (TotalTestTime[ThreadNumber] > 0ULL) ? (double)TotalTestTime[0] / (double)TotalTestTime[ThreadNumber] : 0.0);
+
+        printf(" %12llu %8.2f", Nps, (ReferenceNps > 0ULL) ? (double)Nps / (double)ReferenceNps : 0.0);
+
+        printf(" %8.2f", (TotalNodes[0] > 0ULL) ? (double)TotalNodes[ThreadNumber] / (double)TotalNodes[0] : 0.0);
+
+        printf(" %9.2f%%", (TotalHashProbes[ThreadNumber] > 0ULL) ? 100.0 * (double)TotalHashHits[ThreadNumber] / (double)TotalHashProbes[ThreadNumber] : 0.0);
+
+        printf(" %7d%%\n", 100 * AgreeCount[ThreadNumber] / BratkoKopecTestCount);
+    }
+
+    printf("\n");
+
+    printf("Scaling test...DONE (%s)\n", FileOutName);
+}
+
 void SearchPerformanceTest(void)
 {
     int MaxCycles;
@@ -5,21 +5,110 @@
 #ifndef TESTS_H
 #define TESTS_H
 
+#include "Board.h"
 #include "Def.h"
 #include "Types.h"
 
+#define BENCH_DEFAULT_DEPTH             12
+#define BENCH_DEFAULT_THREADS           1
+#define BENCH_DEFAULT_HASH_TABLE_SIZE   16  // Mb
+
+#define EPD_DEFAULT_NODES   1000000ULL  // Per position
+
+#define EPD_MAX_MOVES       16          // Best (avoid) moves per position
+
+#define EPD_HASH_TABLE_SIZE 16          // Mb (own hash table of the thread, cleared for each position)
+
+#define KERNEL_BASELINE_FILE_NAME   "kernels.txt"
+
+#define KERNEL_RUNS                 10          // Timed runs per kernel (after a warm-up run)
+#define KERNEL_MIN_OPERATIONS       1000000     // Per run
+#define KERNEL_HISTORY_PLY          8           // Reversible moves played from every position (repetition check)
+#define KERNEL_REGRESSION           10.0        // Percent slower than the baseline
+
+#define SCALING_FILE_NAME               "scaling.csv"
+
+#define SCALING_DEFAULT_DEPTH           12
+#define SCALING_DEFAULT_HASH_TABLE_SIZE 64  // Mb
+
 typedef struct {
     char* Fen;
     int Depth;
     U64 Nodes[10];
 } GeneratorTestItem;
 
+typedef struct {
+    char Fen[MAX_FEN_LENGTH];
+    char Id[64];
+
+    char BestMoves[128];    // "bm" operation
+    char AvoidMoves[128];   // "am" operation
+
+    // Result
+
+    char Move[16];          // Best move (SAN)
+    int Score;
+
+    BOOL Solved;
+
+    int Depth;              // Completed depth
+    U64 Nodes;
+    U64 Time;               // Milliseconds
+
+    int SolvedDepth;        // The move is correct since this depth
+    U64 SolvedNodes;
+    U64 SolvedTime;
+} EpdTestItem;
+
+typedef struct {
+    EpdTestItem* Test;
+
+    int BestMoves[EPD_MAX_MOVES];
+    int BestMoveCount;
+
+    int AvoidMoves[EPD_MAX_MOVES];
+    int AvoidMoveCount;
+
+    U64 TimeStart;
+} EpdSearchItem;
+
+typedef struct {
+    BoardItem Board;
+
+    int LegalMoveCount;
+    MoveItem LegalMoveList[MAX_GEN_MOVES];
+
+    int CaptureMoveCount;
+    MoveItem CaptureMoveList[MAX_GEN_MOVES];
+} KernelPositionItem;
+
+typedef int (*KernelFunction)(KernelPositionItem* Position); // Returns operations
+
+typedef struct {
+    const char* Name;
+    KernelFunction Function;
+
+    // Result
+
+    double Time;            // Nanoseconds per operation (mean)
+    double Deviation;       // Nanoseconds per operation (standard deviation)
+    double Cycles;          // Time stamp counter cycles per operation (mean)
+} KernelItem;
+
 void GeneratorTest1(void);
 void GeneratorTest2(void);
 
 void BratkoKopecTest(void);
 void WinAtChessTest(void);
 
+void EpdTest(const char* FileInName, const char* FileOutName, const U64 SearchNodes, const U64 SearchTime);
+
+void Bench(const int Depth, const int Threads, const int HashSizeInMb);
+
+void KernelBenchmark(const char* BaselineFileName, const BOOL SaveBaseline);
+
+void ScalingTest(const int Depth, const int HashSizeInMb, const char* FileOutName);
+
 void SearchPerformanceTest(void);
 void EvaluatePerformanceTest(void);
 
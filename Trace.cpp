@@ -0,0 +1,281 @@
+// Trace.cpp
+
+#include "stdafx.h"
+
+#include "Trace.h"
+
+#include "Def.h"
+#include "Game.h"
+#include "Types.h"
+#include "Utils.h"
+
+int TraceRate = 0;
+
+volatile BOOL TraceSaveRequest = FALSE;
+
+U32 TraceOverhead = 0;
+
+TraceBufferItem TraceBufferList[MAX_THREADS];
+
+const char* TraceEventName[TRACE_EVENT_COUNT] = {
+    "GenerateAllMoves",
+    "GenerateCaptureMoves",
+    "MakeMove",
+    "UnmakeMove",
+    "Evaluate",
+    "LoadHash",
+    "SaveHash",
+    "SEE",
+    "QuiescenceSearch"
+};
+
+void TraceSignal(int Signal)
+{
+    signal(SIGBREAK, TraceSignal); // The handler is reset to default before the call
+
+    SaveTrace(TRACE_FILE_NAME);
+}
+
+void InitTrace(const int Rate)
+{
+    U64 Start;
+    U64 Cycles;
+
+    FreeTrace(); // The trace may have been initialized earlier
+
+    if (Rate <= 0) {
+        return;
+    }
+
+    for (int Thread = 0; Thread < MaxThreads; ++Thread) {
+        TraceBufferList[Thread].Count = 0ULL;
+        TraceBufferList[Thread].Sample = 0;
+
+        TraceBufferList[Thread].Event = (TraceEventItem*)calloc(TRACE_BUFFER_SIZE, sizeof(TraceEventItem));
+
+        if (TraceBufferList[Thread].Event == NULL) { // Allocate memory error
+            printf("Allocate memory to trace buffer error!\n");
+
+            FreeTrace();
+
+            return;
+        }
+    }
+
+    // Cycles of an empty event (subtracted by the summary)
+
+    TraceOverhead = 0xFFFFFFFF;
+
+    for (int Index = 0; Index < 1000; ++Index) {
+        Start = __rdtsc();
+        Cycles = __rdtsc() - Start;
+
+        TraceOverhead = (U32)MIN(Cycles, (U64)TraceOverhead);
+    }
+
+    signal(SIGBREAK, TraceSignal);
+
+    TraceRate = Rate;
+}
+
+void FreeTrace(void)
+{
+    TraceRate = 0; // Stop sampling before the buffers are released
+
+    for (int Thread = 0; Thread < MAX_THREADS; ++Thread) {
+        if (TraceBufferList[Thread].Event) {
+            free(TraceBufferList[Thread].Event);
+
+            TraceBufferList[Thread].Event = NULL;
+        }
+
+        TraceBufferList[Thread].Count = 0ULL;
+    }
+}
+
+U64 TraceStart(void)
+{
+    TraceBufferItem* Buffer = &TraceBufferList[omp_get_thread_num()];
+
+    if (++Buffer->Sample < TraceRate) {
+        return 0ULL;
+    }
+
+    Buffer->Sample = 0;
+
+    return __rdtsc();
+}
+
+void TraceStop(const int Event, const U64 Start)
+{
+    U64 Cycles = __rdtsc() - Start;
+
+    TraceBufferItem* Buffer = &TraceBufferList[omp_get_thread_num()];
+    TraceEventItem* Item = &Buffer->Event[Buffer->Count++ & (TRACE_BUFFER_SIZE - 1)];
+
+    Item->Time = Start;
+    Item->Cycles = (U32)MIN(Cycles, 0xFFFFFFFFULL);
+    Item->Event = (U16)Event;
+    Item->Reserved = 0;
+}
+
+void SaveTrace(const char* FileName) // Events in flight (if any) may be saved partially
+{
+    FILE* File;
+
+    TraceHeaderItem Header;
+
+    U64 Count;
+    U64 First;
+
+    if (TraceRate == 0) {
+        return;
+    }
+
+    fopen_s(&File, FileName, "wb");
+
+    if (File == NULL) { // File create (open) error
+        printf("File '%s' create (open) error!\n", FileName);
+
+        return;
+    }
+
+    Header.Magic = TRACE_MAGIC;
+    Header.Version = TRACE_VERSION;
+    Header.Threads = (U32)MaxThreads;
+    Header.Rate = (U32)TraceRate;
+    Header.Overhead = TraceOverhead;
+    Header.Reserved = 0;
+
+    fwrite(&Header, sizeof(TraceHeaderItem), 1, File);
+
+    // Thread: sampled events (U64), saved events (U64) and saved events (the last sampled events, oldest first)
+
+    for (int Thread = 0; Thread < MaxThreads; ++Thread) {
+        Count = MIN(TraceBufferList[Thread].Count, (U64)TRACE_BUFFER_SIZE);
+        First = (TraceBufferList[Thread].Count - Count) & (TRACE_BUFFER_SIZE - 1);
+
+        fwrite(&TraceBufferList[Thread].Count, sizeof(U64), 1, File);
+        fwrite(&Count, sizeof(U64), 1, File);
+
+        if (First + Count > (U64)TRACE_BUFFER_SIZE) { // Ring buffer wrapped
+            fwrite(&TraceBufferList[Thread].Event[First], sizeof(TraceEventItem), (size_t)(TRACE_BUFFER_SIZE - First), File);
+            fwrite(&TraceBufferList[Thread].Event[0], sizeof(TraceEventItem), (size_t)(First + Count - TRACE_BUFFER_SIZE), File);
+        }
+        else {
+            fwrite(&TraceBufferList[Thread].Event[First], sizeof(TraceEventItem), (size_t)Count, File);
+        }
+    }
+
+    fclose(File);
+}
+
+void PrintTrace(const char* FileName)
+{
+    FILE* File;
+
+    TraceHeaderItem Header;
+    TraceEventItem Item;
+
+    U64 TotalCount;
+    U64 Count;
+
+    double Scale;
+
+    U64 Samples[TRACE_EVENT_COUNT] = { 0ULL };
+    double Events[TRACE_EVENT_COUNT] = { 0.0 }; // Estimated from the sampled events of the thread (the ring buffer may be wrapped)
+    U64 Cycles[TRACE_EVENT_COUNT] = { 0ULL };
+    U64 MinCycles[TRACE_EVENT_COUNT];
+    U64 MaxCycles[TRACE_EVENT_COUNT] = { 0ULL };
+
+    U64 EventCycles;
+    U64 TotalCycles = 0ULL;
+
+    printf("\n");
+
+    printf("Read trace file '%s'...\n", FileName);
+
+    fopen_s(&File, FileName, "rb");
+
+    if (File == NULL) { // File open error
+        printf("File '%s' open error!\n", FileName);
+
+        return;
+    }
+
+    if (fread(&Header, sizeof(TraceHeaderItem), 1, File) != 1 || Header.Magic != TRACE_MAGIC || Header.Version != TRACE_VERSION) {
+        printf("File '%s' format error!\n", FileName);
+
+        fclose(File);
+
+        return;
+    }
+
+    for (int Event = 0; Event < TRACE_EVENT_COUNT; ++Event) {
+        MinCycles[Event] = 0xFFFFFFFFULL;
+    }
+
+    for (U32 Thread = 0; Thread < Header.Threads; ++Thread) {
+        if (fread(&TotalCount, sizeof(U64), 1, File) != 1 || fread(&Count, sizeof(U64), 1, File) != 1) {
+            break; // for
+        }
+
+        Scale = (Count > 0ULL) ? (double)Header.Rate * (double)TotalCount / (double)Count : 0.0;
+
+        for (U64 Index = 0ULL; Index < Count; ++Index) {
+            if (fread(&Item, sizeof(TraceEventItem), 1, File) != 1) {
+                break; // for
+            }
+
+            if (Item.Event >= TRACE_EVENT_COUNT) {
+                continue; // Next event
+            }
+
+            EventCycles = (Item.Cycles > Header.Overhead) ? (U64)(Item.Cycles - Header.Overhead) : 0ULL;
+
+            ++Samples[Item.Event];
+
+            Events[Item.Event] += Scale;
+
+            Cycles[Item.Event] += EventCycles;
+
+            MinCycles[Item.Event] = MIN(MinCycles[Item.Event], EventCycles);
+            MaxCycles[Item.Event] = MAX(MaxCycles[Item.Event], EventCycles);
+        }
+    }
+
+    fclose(File);
+
+    printf("DONE\n");
+
+    for (int Event = 0; Event < TRACE_EVENT_COUNT; ++Event) {
+        if (Event != TRACE_QUIESCENCE) { // Inclusive
+            TotalCycles += Cycles[Event];
+        }
+    }
+
+    printf("\n");
+
+    printf("Threads = %u Rate = 1/%u Overhead = %u cycles\n", Header.Threads, Header.Rate, Header.Overhead);
+
+    printf("\n");
+
+    printf("%-22s %10s %14s %10s %10s %10s %8s\n", "Event", "Samples", "Events (est.)", "Cycles", "Min.", "Max.", "Share");
+
+    for (int Event = 0; Event < TRACE_EVENT_COUNT; ++Event) {
+        if (Samples[Event] == 0ULL) {
+            printf("%-22s %10d\n", TraceEventName[Event], 0);
+
+            continue; // Next event
+        }
+
+        printf("%-22s %10llu %14.0f %10.1f %10llu %10llu", TraceEventName[Event], Samples[Event], Events[Event], (double)Cycles[Event] / (double)Samples[Event], MinCycles[Event], MaxCycles[Event]);
+
+        if (Event == TRACE_QUIESCENCE) {
+            printf(" %8s\n", "incl.");
+        }
+        else {
+            printf(" %7.2f%%\n", (TotalCycles > 0ULL) ? 100.0 * (double)Cycles[Event] / (double)TotalCycles : 0.0);
+        }
+    }
+}
\ No newline at end of file
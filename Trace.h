@@ -0,0 +1,78 @@
+// Trace.h
+
+#pragma once
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "Def.h"
+#include "Types.h"
+
+#define TRACE_FILE_NAME                 "trace.bin"
+
+#define TRACE_MAGIC                     0x52544B52  // "RKTR"
+#define TRACE_VERSION                   2
+
+#define TRACE_BUFFER_SIZE               65536       // Events per thread (1 Mb)
+
+#define TRACE_MAX_RATE                  1048576     // 1-in-N events
+
+// Events
+
+#define TRACE_GENERATE_ALL_MOVES        0
+#define TRACE_GENERATE_CAPTURE_MOVES    1
+#define TRACE_MAKE_MOVE                 2
+#define TRACE_UNMAKE_MOVE               3
+#define TRACE_EVALUATE                  4
+#define TRACE_LOAD_HASH                 5
+#define TRACE_SAVE_HASH                 6
+#define TRACE_SEE                       7
+#define TRACE_QUIESCENCE                8   // Quiescence search from search (includes the events above)
+
+#define TRACE_EVENT_COUNT               9
+
+// Near-zero cost if not used (one predictable branch); 0 = event not sampled
+#define TRACE_START()                   ((TraceRate > 0) ? TraceStart() : 0ULL)
+#define TRACE_STOP(Event, Start)        do { if (Start) TraceStop((Event), (Start)); } while (0)
+
+typedef struct {
+    U64 Time;       // Time stamp counter at the start of the event
+    U32 Cycles;
+    U16 Event;
+    U16 Reserved;
+} TraceEventItem; // 16 bytes
+
+typedef struct {
+    _declspec(align(64)) U64 Count; // Events (total)
+
+    int Sample;                     // Events since the last sampled event
+
+    TraceEventItem* Event;          // [TRACE_BUFFER_SIZE]
+} TraceBufferItem; // 64 bytes
+
+typedef struct {
+    U32 Magic;
+    U32 Version;
+
+    U32 Threads;
+    U32 Rate;
+
+    U32 Overhead;   // Cycles of an empty event
+    U32 Reserved;
+} TraceHeaderItem; // 24 bytes
+
+extern int TraceRate; // 0 = not used
+
+extern volatile BOOL TraceSaveRequest;
+
+void InitTrace(const int Rate);
+void FreeTrace(void);
+
+U64 TraceStart(void);
+void TraceStop(const int Event, const U64 Start);
+
+void SaveTrace(const char* FileName);
+
+void PrintTrace(const char* FileName);
+
+#endif // !TRACE_H
\ No newline at end of file
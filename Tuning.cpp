@@ -4,71 +4,205 @@
 
 #include "Tuning.h"
 
+#include "BitBoard.h"
 #include "Board.h"
+#include "Book.h"
 #include "Def.h"
 #include "Game.h"
 #include "Gen.h"
 #include "Hash.h"
 #include "Move.h"
+#include "NNUE2.h"
+#include "Pgn.h"
+#include "Polyglot.h"
+#include "QuiescenceSearch.h"
+#include "Search.h"
 #include "Types.h"
+#include "Utils.h"
 
-#define STAGE_NONE      1
-#define STAGE_TAG       2
-#define STAGE_NOTATION  3
-#define STAGE_MOVE      4
-#define STAGE_COMMENT   5
+void PackPosition(const BoardItem* Board, const int Result, const int Score, const int Flags, PackedPositionItem* Position)
+{
+    U64 Occupied = Board->BB_WhitePieces | Board->BB_BlackPieces;
 
-void Pgn2Fen(void)
+    int Square;
+
+    int Index = 0;
+
+    Position->Occupied = Occupied;
+
+    memset(Position->Pieces, 0, sizeof(Position->Pieces));
+
+    while (Occupied && Index < 32) {
+        Square = LSB(Occupied);
+
+        Position->Pieces[Index >> 1] |= (U8)(Board->Pieces[Square] << ((Index & 1) << 2)); // Low nibble first
+
+        ++Index;
+
+        Occupied &= Occupied - 1;
+    }
+
+    Position->CurrentColor = (U8)Board->CurrentColor;
+    Position->CastleFlags = (U8)Board->CastleFlags;
+    Position->PassantSquare = (I8)Board->PassantSquare;
+    Position->FiftyMove = (U8)MIN(Board->FiftyMove, 255);
+
+    Position->Result = (I8)Result;
+    Position->Flags = (U8)Flags;
+    Position->Score = (I16)MAX(MIN(Score, 32767), -32767);
+}
+
+void UnpackPosition(BoardItem* Board, const PackedPositionItem* Position)
 {
-    FILE* FileIn;
-    FILE* FileOut;
+    U64 Occupied = Position->Occupied;
 
-    int GameNumber;
+    int Square;
+    int Piece;
 
-    double Result;
+    int Index = 0;
 
-    int Ply;
+    // Clear board
 
-    BOOL Error;
+    for (Square = 0; Square < 64; ++Square) {
+        Board->Pieces[Square] = NO_PIECE;
+    }
 
-    char MoveString[16];
-    char* Move;
+    Board->BB_WhitePieces = 0ULL;
+    Board->BB_BlackPieces = 0ULL;
 
-    int Stage;
+    for (int Color = 0; Color < 2; ++Color) { // White/Black
+        for (int PieceType = 0; PieceType < 6; ++PieceType) { // PNBRQK
+            Board->BB_Pieces[Color][PieceType] = 0ULL;
+        }
+    }
 
-    char Buf[4096];
-    char* Part;
+    // Load pieces
 
-    char FenString[MAX_FEN_LENGTH];
-    char* Fen;
+    while (Occupied) {
+        Square = LSB(Occupied);
 
-    char FenOut[MAX_FEN_LENGTH];
+        Piece = (Position->Pieces[Index >> 1] >> ((Index & 1) << 2)) & 15; // Low nibble first
 
-    int GenMoveCount;
-    MoveItem MoveList[MAX_GEN_MOVES];
+        Board->Pieces[Square] = Piece;
 
-    BOOL MoveFound;
+        if (PIECE_COLOR(Piece) == WHITE) {
+            Board->BB_WhitePieces |= BB_SQUARE(Square);
+        }
+        else { // BLACK
+            Board->BB_BlackPieces |= BB_SQUARE(Square);
+        }
 
-    char NotateMoveStr[16];
+        Board->BB_Pieces[PIECE_COLOR(Piece)][PIECE_TYPE(Piece)] |= BB_SQUARE(Square);
 
-    printf("\n");
+        ++Index;
 
-    printf("Convert PGN file to FEN file...\n");
+        Occupied &= Occupied - 1;
+    }
 
-    fopen_s(&FileIn, "games.pgn", "r");
+    // Load color, castle flags, en passant square and fifty move
 
-    if (FileIn == NULL) { // File open error
-        printf("File 'games.pgn' open error!\n");
+    Board->CurrentColor = Position->CurrentColor;
+    Board->CastleFlags = Position->CastleFlags;
+    Board->PassantSquare = Position->PassantSquare;
+    Board->FiftyMove = Position->FiftyMove;
+
+    Board->HalfMoveNumber = Board->CurrentColor; // Move number is not stored
+
+    InitAccumulator(Board);
+
+    InitHash(Board);
+
+    memset(Board->MoveTable, 0, sizeof(Board->MoveTable));
+    memset(Board->RepetitionFilter, 0, sizeof(Board->RepetitionFilter));
+}
+
+BOOL OpenPackedReader(PackedReaderItem* Reader, const char* FileName)
+{
+    fopen_s(&Reader->File, FileName, "rb");
+
+    if (Reader->File == NULL) { // File open error
+        printf("File '%s' open error!\n", FileName);
+
+        return FALSE;
+    }
+
+    Reader->Position = (PackedPositionItem*)malloc(PACKED_BUFFER_SIZE * sizeof(PackedPositionItem));
+
+    if (Reader->Position == NULL) { // Allocate memory error
+        printf("Allocate memory to packed reader error!\n");
+
+        fclose(Reader->File);
+
+        return FALSE;
+    }
+
+    Reader->Count = 0;
+    Reader->Index = 0;
 
+    return TRUE;
+}
+
+const PackedPositionItem* ReadPackedPosition(PackedReaderItem* Reader, BoardItem* Board)
+{
+    if (Reader->Index == Reader->Count) { // Read next block
+        Reader->Count = (int)fread(Reader->Position, sizeof(PackedPositionItem), PACKED_BUFFER_SIZE, Reader->File);
+        Reader->Index = 0;
+
+        if (Reader->Count == 0) { // End of file
+            return NULL;
+        }
+    }
+
+    UnpackPosition(Board, &Reader->Position[Reader->Index]);
+
+    return &Reader->Position[Reader->Index++];
+}
+
+void ClosePackedReader(PackedReaderItem* Reader)
+{
+    free(Reader->Position);
+
+    fclose(Reader->File);
+}
+
+void ConvertPgn(const char* FileOutName, const BOOL Packed)
+{
+    FILE* FileOut;
+
+    PgnReaderItem Reader;
+    const PgnGameItem* Game;
+
+    BoardItem* ThreadBoard;
+
+    int GameNumber;
+
+    double Result;
+
+    int Size;
+
+    char FenOut[MAX_FEN_LENGTH];
+
+    char** GameData; // [GameCount] packed positions or FEN strings of a game
+    int* GameDataSize;
+
+    BOOL Error = FALSE;
+
+    int SavedThreads;
+
+    printf("\n");
+
+    printf("Convert PGN file to %s file...\n", Packed ? "packed" : "FEN");
+
+    if (!OpenPgnReader(&Reader, "games.pgn", MAX_PGN_MOVES, 0)) {
         return;
     }
 
-    fopen_s(&FileOut, "games.fen", "w");
+    fopen_s(&FileOut, FileOutName, Packed ? "wb" : "w");
 
     if (FileOut == NULL) { // File create (open) error
-        printf("File 'games.fen' create (open) error!\n");
+        printf("File '%s' create (open) error!\n", FileOutName);
 
-        fclose(FileIn);
+        ClosePgnReader(&Reader);
 
         return;
     }
@@ -77,222 +211,706 @@ void Pgn2Fen(void)
 
     InitHashTable(1);
 
-    // Threads not used
+    // Threads are used to parse games and to convert positions (positions are written in game order)
 
-    omp_set_num_threads(1);
+    SavedThreads = omp_get_max_threads(); // Restored at the end
 
-    // Prepare new game
+    omp_set_num_threads(MaxThreads);
 
-    GameNumber = 1;
+    GameNumber = 0;
 
-    Result = 0.0; // Draw default
+    printf("\n");
 
-    Ply = 0;
+    while (!Error && ReadPgnGames(&Reader)) {
+        GameData = (char**)calloc(Reader.GameCount, sizeof(char*));
+        GameDataSize = (int*)calloc(Reader.GameCount, sizeof(int));
 
-    Error = FALSE;
+        if (GameData == NULL || GameDataSize == NULL) { // Allocate memory error
+            printf("Allocate memory to convert PGN error!\n");
 
-    Move = MoveString;
-    *Move = '\0'; // Nul
+            free(GameData);
+            free(GameDataSize);
 
-    SetFen(&CurrentBoard, StartFen);
+            break; // while
+        }
 
-    Stage = STAGE_NONE;
+        // Convert games (each thread uses own board)
 
-    printf("\n");
+#pragma omp parallel for schedule(dynamic, 16) private(Game, ThreadBoard, Result, Size, FenOut)
+        for (int GameIndex = 0; GameIndex < Reader.GameCount; ++GameIndex) {
+            Game = &Reader.Game[GameIndex];
 
-    while (fgets(Buf, sizeof(Buf), FileIn) != NULL) {
-        Part = Buf;
+            Result = (Game->Result + 1) / 2.0; // 1.0, 0.5 or 0.0
 
-        if (*Part == '\r' || *Part == '\n') { // Empty string
-            if (Stage == STAGE_NOTATION) {
-                // Prepare new game
+            Size = (Game->MoveCount + 1) * (Packed ? (int)sizeof(PackedPositionItem) : MAX_FEN_LENGTH + 8); // Position: FEN + "|0.5\n"
 
-                ++GameNumber;
+            ThreadBoard = &ThreadBoardList[omp_get_thread_num()];
 
-                Result = 0.0; // Draw default
+            GameData[GameIndex] = (char*)malloc(Size);
 
-                Ply = 0;
+            if (GameData[GameIndex] == NULL) { // Allocate memory error (reported after the loop)
+                continue; // Next game
+            }
 
-                Error = FALSE;
+            SetFen(ThreadBoard, Game->Fen);
 
-                Move = MoveString;
-                *Move = '\0'; // Nul
+            for (int Ply = 0; Ply <= Game->MoveCount; ++Ply) {
+                if (Ply > 0) {
+                    MakeMove(ThreadBoard, CreateMoveItem(ThreadBoard, Game->Move[Ply - 1]));
+                }
 
-                SetFen(&CurrentBoard, StartFen);
+                if (Packed) {
+                    PackPosition(ThreadBoard, Game->Result, 0, 0, (PackedPositionItem*)GameData[GameIndex] + Ply);
 
-                Stage = STAGE_NONE;
-            }
+                    GameDataSize[GameIndex] += (int)sizeof(PackedPositionItem);
+                }
+                else {
+                    GetFen(ThreadBoard, FenOut); // First FEN in game is StartFen or FEN from FEN-tag
 
-            continue; // Next string
+                    GameDataSize[GameIndex] += sprintf_s(GameData[GameIndex] + GameDataSize[GameIndex], Size - GameDataSize[GameIndex], "%s|%.1f\n", FenOut, Result);
+                }
+            }
         }
 
-        if (*Part == '[') { // Tag
-            if (Stage == STAGE_NONE) {
-                if (GameNumber > 1 && (GameNumber - 1) % 10000 == 0) {
-                    printf("Game number = %d\n", GameNumber - 1);
+        // Write games (in file order)
+
+        for (int GameIndex = 0; GameIndex < Reader.GameCount; ++GameIndex) {
+            if (GameData[GameIndex] == NULL) { // Allocate memory error
+                if (!Error) {
+                    printf("Allocate memory to convert PGN error!\n");
                 }
 
-                Stage = STAGE_TAG;
+                Error = TRUE;
+
+                continue; // Next game
             }
 
-            if (strncmp(Part, "[Result \"1-0\"]", 14) == 0) { // Result 1-0
-                Result = 1.0;
+            if (!Error) {
+                ++GameNumber;
 
-//                printf("Result = %.1f\n", Result);
-            }
-            else if (strncmp(Part, "[Result \"1/2-1/2\"]", 18) == 0) { // Result 1/2-1/2
-                Result = 0.5;
+                fwrite(GameData[GameIndex], 1, GameDataSize[GameIndex], FileOut);
 
-//                printf("Result = %.1f\n", Result);
+                if (GameNumber % 10000 == 0) {
+                    printf("Game number = %d\n", GameNumber);
+                }
             }
-            else if (strncmp(Part, "[Result \"0-1\"]", 14) == 0) { // Result 0-1
-                Result = 0.0;
 
-//                printf("Result = %.1f\n", Result);
+            free(GameData[GameIndex]);
+        }
+
+        free(GameData);
+        free(GameDataSize);
+    } // while
+
+    printf("Game number = %d\n", GameNumber);
+
+    fclose(FileOut);
+
+    ClosePgnReader(&Reader);
+
+    omp_set_num_threads(SavedThreads);
+
+    printf("\n");
+
+    printf("Convert PGN file to %s file...DONE\n", Packed ? "packed" : "FEN");
+}
+
+void Pgn2Fen(void)
+{
+    ConvertPgn("games.fen", FALSE);
+}
+
+void Pgn2Packed(void)
+{
+    ConvertPgn("games.bin", TRUE);
+}
+
+/*
+    https://prng.di.unimi.it/splitmix64.c
+*/
+U64 DataRand64(U64* State)
+{
+    U64 Result = (*State += 0x9E3779B97F4A7C15);
+
+    Result = (Result ^ (Result >> 30)) * 0xBF58476D1CE4E5B9;
+    Result = (Result ^ (Result >> 27)) * 0x94D049BB133111EB;
+
+    return Result ^ (Result >> 31);
+}
+
+BOOL PlayDataOpening(BoardItem* Board, U64* RandState)
+{
+    int GenMoveCount;
+    MoveListItem MoveList;
+
+    int LegalMoveCount;
+    int LegalMoves[MAX_GEN_MOVES];
+
+    MoveItem CurrentMove;
+
+    BOOL BookMove;
+
+    SetFen(Board, StartFen);
+
+    // Book moves
+
+    while (Board->HalfMoveNumber < DATA_BOOK_PLY) {
+        BookMove = GetBookMove(Board, DataRand64(RandState), Board->BestMovesRoot) || GetPolyglotBookMove(Board, DataRand64(RandState), Board->BestMovesRoot); // Own random state of the game (Rand64 is not thread safe)
+
+        if (!BookMove) {
+            break; // while
+        }
+
+        MakeMove(Board, Board->BestMovesRoot[0]);
+    }
+
+    // Random moves
+
+    for (int Ply = 0; Ply < DATA_RANDOM_PLY; ++Ply) {
+        GenMoveCount = 0;
+        GenerateAllMoves(Board, NULL, &MoveList, &GenMoveCount);
+
+        LegalMoveCount = 0;
+
+        for (int MoveNumber = 0; MoveNumber < GenMoveCount; ++MoveNumber) {
+            CurrentMove = CreateMoveItem(Board, MoveList.Move[MoveNumber]);
+
+            MakeMove(Board, CurrentMove);
+
+            if (!IsInCheck(Board, CHANGE_COLOR(Board->CurrentColor))) { // Legal move
+                LegalMoves[LegalMoveCount++] = MoveList.Move[MoveNumber];
             }
-            else if (strncmp(Part, "[FEN \"", 6) == 0) { // FEN
-                Part += 6;
 
-                Fen = FenString;
+            UnmakeMove(Board);
+        }
 
-                while (*Part != '"') {
-                    *Fen++ = *Part++; // Copy FEN
-                }
+        if (LegalMoveCount == 0) { // Checkmate or stalemate
+            return FALSE;
+        }
+
+        MakeMove(Board, CreateMoveItem(Board, LegalMoves[DataRand64(RandState) % LegalMoveCount]));
+    }
+
+    return TRUE;
+}
+
+int PlayDataGame(BoardItem* Board, HashStoreItem* Store, U64* RandState, const int SearchDepth, const U64 SearchNodes, PackedPositionItem* Positions, int* PositionCount, U64* Nodes)
+{
+    BOOL InCheck;
+
+    int Score;
+    int WhiteScore;
+
+    MoveItem BestMove;
+
+    int WhiteWinPly = 0;
+    int BlackWinPly = 0;
+    int DrawPly = 0;
+
+    *PositionCount = 0;
 
-                *Fen = '\0'; // Nul
+    while (!PlayDataOpening(Board, RandState)); // Repeat if the game is over in the opening
 
-//                printf("FEN = %s\n", FenString);
+    Board->HashStore = Store; // Own hash table of the thread (SetFen sets the shared hash table)
 
-                SetFen(&CurrentBoard, FenString);
+    for (int Ply = 0; Ply < DATA_MAX_PLY; ++Ply) {
+        if (IsInsufficientMaterial(Board) || Board->FiftyMove >= 100 || PositionRepeat2(Board) == 2) { // Draw
+            return 0;
+        }
+
+        InCheck = IsInCheck(Board, Board->CurrentColor);
+
+        Score = SearchIterative(Board, SearchDepth, SearchNodes, 0ULL, InCheck, NULL, NULL);
+
+        *Nodes += Board->Nodes;
+
+        BestMove = Board->BestMovesRoot[0];
+
+        if (!BestMove.Move) { // No legal moves
+            if (InCheck) { // Checkmate
+                return (Board->CurrentColor == WHITE ? -1 : 1);
             }
 
-            continue; // Next string
-        } // if
+            return 0; // Stalemate
+        }
+
+        WhiteScore = (Board->CurrentColor == WHITE ? Score : -Score);
+
+        if (Score <= -INF + MAX_PLY || Score >= INF - MAX_PLY) { // Checkmate (found)
+            return (WhiteScore > 0 ? 1 : -1);
+        }
+
+        // Win adjudication
 
-        if (Stage == STAGE_TAG) {
-            GetFen(&CurrentBoard, FenOut); // First FEN in game (StartFen or FenString from FEN-tag)
+        if (WhiteScore >= DATA_WIN_SCORE) {
+            ++WhiteWinPly;
+            BlackWinPly = 0;
+        }
+        else if (WhiteScore <= -DATA_WIN_SCORE) {
+            WhiteWinPly = 0;
+            ++BlackWinPly;
+        }
+        else {
+            WhiteWinPly = 0;
+            BlackWinPly = 0;
+        }
 
-            fprintf(FileOut, "%s|%.1f\n", FenOut, Result);
+        if (WhiteWinPly >= DATA_WIN_PLY) {
+            return 1;
+        }
 
-            ++Ply;
+        if (BlackWinPly >= DATA_WIN_PLY) {
+            return -1;
+        }
 
-            Stage = STAGE_NOTATION;
+        // Draw adjudication
+
+        if (Ply >= DATA_DRAW_START_PLY && ABS(WhiteScore) <= DATA_DRAW_SCORE) {
+            ++DrawPly;
+        }
+        else {
+            DrawPly = 0;
         }
 
-        if (Error) {
-            continue; // Next string
+        if (DrawPly >= DATA_DRAW_PLY) {
+            return 0;
+        }
+
+        // Save quiet positions (the result is set at the end of the game)
+
+        if (!InCheck && !(BestMove.Type & (MOVE_CAPTURE | MOVE_PAWN_PROMOTE))) {
+            PackPosition(Board, 0, WhiteScore, PACKED_SCORE, &Positions[(*PositionCount)++]);
         }
 
-        while (*Part != '\0') { // Scan string
-            if (*Part == '{') { // Comment (open)
-                Stage = STAGE_COMMENT;
+        MakeMove(Board, BestMove);
+    }
+
+    return 0; // Draw (max. ply)
+}
+
+void GenerateData(void)
+{
+    FILE* FileOut;
+
+    int InputGames;
+    int InputDepth;
+    int InputNodes;
+
+    int GameCount;
+    int SearchDepth;
+    U64 SearchNodes;
+
+    U64 Seed;
+
+    U64 RandState;
+
+    BoardItem* ThreadBoard;
+
+    HashStoreItem ThreadHashStore;
+
+    int Result;
+
+    PackedPositionItem* Positions;
+    int PositionCount;
+
+    U64 ThreadNodes;
+
+    int GamesDone = 0;
+    U64 PositionsDone = 0ULL;
+    U64 NodesDone = 0ULL;
+
+    int Results[3] = { 0, 0, 0 }; // Black win, draw, white win
+
+    U64 DataTimeStart;
+    U64 DataTime;
+
+    int SavedThreads;
+
+    printf("\n");
+
+    printf("Games (min. 1; 0 = %d): ", DATA_DEFAULT_GAMES);
+    scanf_s("%d", &InputGames);
+
+    GameCount = (InputGames >= 1) ? InputGames : DATA_DEFAULT_GAMES;
+
+    printf("Depth (min. 1 max. %d; 0 = %d): ", MAX_PLY, DATA_DEFAULT_DEPTH);
+    scanf_s("%d", &InputDepth);
+
+    SearchDepth = (InputDepth >= 1 && InputDepth <= MAX_PLY) ? InputDepth : DATA_DEFAULT_DEPTH;
+
+    printf("Nodes (0 = depth only): ");
+    scanf_s("%d", &InputNodes);
+
+    SearchNodes = (InputNodes >= 1) ? (U64)InputNodes : 0ULL;
+
+    printf("\n");
+
+    printf("Generate self-play data...\n");
+
+    fopen_s(&FileOut, DATA_FILE_NAME, "wb");
+
+    if (FileOut == NULL) { // File create (open) error
+        printf("File '%s' create (open) error!\n", DATA_FILE_NAME);
+
+        return;
+    }
+
+    // One game per thread (own hash table of the thread: the games do not depend on each other)
+
+    TimeStart = Clock();
+    TimeStop = ULLONG_MAX; // Time is not used
+
+    MaxNodes = 0ULL; // Global node limit is not used (one search per thread)
+
+    CompletedDepth = 0;
+
+    StopSearch = FALSE;
+
+    SavedThreads = omp_get_max_threads(); // Restored at the end
+
+    omp_set_num_threads(MaxThreads);
+
+    Seed = Rand64();
+
+    DataTimeStart = Clock();
+
+    printf("\n");
+
+    printf("Threads = %d\n", MaxThreads);
+
+    printf("\n");
+
+#pragma omp parallel private(ThreadBoard, ThreadHashStore, RandState, Result, Positions, PositionCount, ThreadNodes)
+    {
+        ThreadBoard = &ThreadBoardList[omp_get_thread_num()];
+
+        Positions = (PackedPositionItem*)malloc(DATA_MAX_PLY * sizeof(PackedPositionItem));
+
+        if (Positions == NULL) { // Allocate memory error
+#pragma omp critical
+            {
+                printf("Allocate memory to positions error!\n");
             }
-            else if (*Part == '}') { // Comment (close)
-                Stage = STAGE_NOTATION;
+        }
+
+        InitHashStore(&ThreadHashStore, DATA_HASH_TABLE_SIZE); // Own hash table of the thread (NULL items if allocate memory error)
+
+#pragma omp for schedule(dynamic)
+        for (int GameNumber = 0; GameNumber < GameCount; ++GameNumber) {
+            if (Positions == NULL || ThreadHashStore.Item == NULL) {
+                continue; // Next game
             }
 
-            if (Stage == STAGE_NOTATION) {
-                if (strchr(MoveFirstChar, *Part) != NULL) {
-                    Stage = STAGE_MOVE;
+            RandState = Seed ^ ((U64)GameNumber * 0xD1B54A32D192ED03ULL);
 
-                    Move = MoveString;
+            ThreadNodes = 0ULL;
 
-                    *Move++ = *Part; // Copy move (first char)
-                }
+            ClearHashStore(&ThreadHashStore);
+
+            Result = PlayDataGame(ThreadBoard, &ThreadHashStore, &RandState, SearchDepth, SearchNodes, Positions, &PositionCount, &ThreadNodes);
+
+            for (int Index = 0; Index < PositionCount; ++Index) {
+                Positions[Index].Result = (I8)Result;
             }
-            else if (Stage == STAGE_MOVE) {
-                if (strchr(MoveSubsequentChar, *Part) != NULL) {
-                    *Move++ = *Part; // Copy move (subsequent char)
+
+#pragma omp critical
+            {
+                fwrite(Positions, sizeof(PackedPositionItem), PositionCount, FileOut);
+
+                ++GamesDone;
+                PositionsDone += PositionCount;
+                NodesDone += ThreadNodes;
+
+                ++Results[Result + 1];
+
+                if (GamesDone % 100 == 0) {
+                    DataTime = Clock() - DataTimeStart;
+
+                    printf("Games = %d Positions = %llu Time = %.1f sec. Positions/sec. = %.0f\n", GamesDone, PositionsDone, (double)DataTime / 1000.0, DataTime > 0ULL ? 1000.0 * (double)PositionsDone / (double)DataTime : 0.0);
                 }
-                else { // End of move
-                    *Move = '\0'; // Nul
+            }
+        }
+
+        free(Positions);
+
+        FreeHashStore(&ThreadHashStore);
+
+        ThreadBoard->HashStore = &HashStore; // Own hash table is freed
+    } // pragma omp parallel
+
+    DataTime = Clock() - DataTimeStart;
+
+    omp_set_num_threads(SavedThreads);
+
+    fclose(FileOut);
+
+    printf("\n");
 
-                    Stage = STAGE_NOTATION;
+    printf("Games = %d (white win %d draw %d black win %d)\n", GamesDone, Results[2], Results[1], Results[0]);
+    printf("Positions = %llu (%s)\n", PositionsDone, DATA_FILE_NAME);
 
-                    if (Error) {
-                        ++Part;
+    printf("Time = %.1f sec.", (double)DataTime / 1000.0);
 
-                        continue; // Next character in string
-                    }
+    if (DataTime >= 1000ULL) {
+        printf(" NPS %llu", 1000ULL * NodesDone / DataTime);
+    }
 
-//                    printf("Move = %s\n", MoveString);
+    printf("\n");
 
-                    GenMoveCount = 0;
-                    GenerateAllMoves(&CurrentBoard, NULL, MoveList, &GenMoveCount);
+    printf("\n");
 
-                    MoveFound = FALSE;
+    printf("Generate self-play data...DONE\n");
+}
 
-                    for (int MoveNumber = 0; MoveNumber < GenMoveCount; ++MoveNumber) {
-                        NotateMove(&CurrentBoard, MoveList[MoveNumber], NotateMoveStr);
+BOOL ReadPositionFen(const char* Line, char* Fen)
+{
+    const char* Part = Line;
+    char* FenPart = Fen;
 
-                        if (strcmp(MoveString, NotateMoveStr) == 0) {
-                            MakeMove(&CurrentBoard, MoveList[MoveNumber]);
+    int Field = 0;
 
-                            if (IsInCheck(&CurrentBoard, CHANGE_COLOR(CurrentBoard.CurrentColor))) { // Illegal move
-                                UnmakeMove(&CurrentBoard);
+    while (Field < 6) {
+        while (*Part == ' ' || *Part == '\t') {
+            ++Part;
+        }
 
-                                PrintBoard(&CurrentBoard);
+        if (*Part == '\0' || *Part == '\r' || *Part == '\n' || *Part == '|' || *Part == ';') { // End of FEN
+            break; // while
+        }
 
-                                printf("\n");
+        if (Field >= 4 && (*Part < '0' || *Part > '9')) { // EPD operations
+            break; // while
+        }
 
-                                printf("Illegal move (%s)!\n", MoveString);
+        if (Field > 0) {
+            *FenPart++ = ' ';
+        }
 
-                                continue; // Next move
-                            }
+        while (*Part != '\0' && *Part != ' ' && *Part != '\t' && *Part != '\r' && *Part != '\n' && *Part != '|' && *Part != ';' && FenPart < Fen + MAX_FEN_LENGTH - 8) {
+            *FenPart++ = *Part++;
+        }
 
-                            MoveFound = TRUE;
+        ++Field;
+    }
 
-                            break; // for
-                        }
-                    }
+    *FenPart = '\0'; // Nul
 
-                    if (MoveFound) {
-                        GetFen(&CurrentBoard, FenOut);
+    if (Field < 4) { // Not a position (empty string or comment)
+        return FALSE;
+    }
+
+    if (Field == 4) { // EPD
+        strcat_s(Fen, MAX_FEN_LENGTH, " 0 1");
+    }
+    else if (Field == 5) {
+        strcat_s(Fen, MAX_FEN_LENGTH, " 1");
+    }
+
+    return TRUE;
+}
 
-                        fprintf(FileOut, "%s|%.1f\n", FenOut, Result);
-                    }
-                    else { // Move not found
-                        Error = TRUE;
+void EvaluateFile(const char* FileInName, const char* FileOutName, const int SearchDepth)
+{
+    FILE* FileIn;
+    FILE* FileOut;
 
-                        PrintBoard(&CurrentBoard);
+    char* Lines; // [EVALUATE_BATCH_SIZE][EVALUATE_MAX_LINE_LENGTH]
+    char* Fens; // [EVALUATE_BATCH_SIZE][MAX_FEN_LENGTH]
 
-                        printf("\n");
+    char* Line;
 
-                        printf("Move (%s) not found!\n", MoveString);
+    BOOL* Valid;
 
-                        printf("\n");
+    int* StaticScores;
+    int* SearchScores;
 
-                        printf("Gen. moves:");
+    int LineCount;
 
-                        for (int MoveNumber = 0; MoveNumber < GenMoveCount; ++MoveNumber) {
-                            NotateMove(&CurrentBoard, MoveList[MoveNumber], NotateMoveStr);
+    BoardItem* ThreadBoard;
+    BOOL InCheck;
 
-                            printf(" %s%s", BoardName[MOVE_FROM(MoveList[MoveNumber].Move)], BoardName[MOVE_TO(MoveList[MoveNumber].Move)]);
+    char* Part;
 
-                            if (MoveList[MoveNumber].Type & MOVE_PAWN_PROMOTE) {
-                                printf("%c", PiecesCharBlack[MOVE_PROMOTE_PIECE_TYPE(MoveList[MoveNumber].Move)]);
-                            }
+    U64 PositionCount = 0ULL;
 
-                            printf(" (%s)", NotateMoveStr);
-                        }
+    U64 EvaluateTimeStart;
+    U64 EvaluateTime;
 
-                        printf("\n");
-                    }
+    int SavedThreads;
 
-                    ++Ply;
+    printf("\n");
+
+    printf("Evaluate positions from file...\n");
+
+    fopen_s(&FileIn, FileInName, "r");
+
+    if (FileIn == NULL) { // File open error
+        printf("File '%s' open error!\n", FileInName);
+
+        return;
+    }
+
+    fopen_s(&FileOut, FileOutName, "w");
+
+    if (FileOut == NULL) { // File create (open) error
+        printf("File '%s' create (open) error!\n", FileOutName);
+
+        fclose(FileIn);
+
+        return;
+    }
+
+    Lines = (char*)malloc(EVALUATE_BATCH_SIZE * EVALUATE_MAX_LINE_LENGTH);
+    Fens = (char*)malloc(EVALUATE_BATCH_SIZE * MAX_FEN_LENGTH);
+
+    Valid = (BOOL*)malloc(EVALUATE_BATCH_SIZE * sizeof(BOOL));
+
+    StaticScores = (int*)malloc(EVALUATE_BATCH_SIZE * sizeof(int));
+    SearchScores = (int*)malloc(EVALUATE_BATCH_SIZE * sizeof(int));
+
+    if (Lines == NULL || Fens == NULL || Valid == NULL || StaticScores == NULL || SearchScores == NULL) { // Allocate memory error
+        printf("Allocate memory to positions error!\n");
+
+        goto Done;
+    }
+
+    // Search settings (time is not used)
+
+    if (SearchDepth >= 0) {
+        ClearHashTable();
+
+        TimeStart = Clock();
+        TimeStop = ULLONG_MAX;
+
+        MaxNodes = 0ULL; // Node limit is not used
+
+        CompletedDepth = 0;
+
+        StopSearch = FALSE;
+    }
+
+    SavedThreads = omp_get_max_threads(); // Restored at the end
+
+    omp_set_num_threads(MaxThreads);
+
+    printf("\n");
+
+    printf("Threads = %d\n", MaxThreads);
+
+    if (SearchDepth == 0) {
+        printf("Quiescence search\n");
+    }
+    else if (SearchDepth > 0) {
+        printf("Search depth = %d\n", SearchDepth);
+    }
+
+    printf("\n");
+
+    EvaluateTimeStart = Clock();
+
+    while (TRUE) {
+        // Read batch
+
+        for (LineCount = 0; LineCount < EVALUATE_BATCH_SIZE; ++LineCount) {
+            if (fgets(Lines + LineCount * EVALUATE_MAX_LINE_LENGTH, EVALUATE_MAX_LINE_LENGTH, FileIn) == NULL) {
+                break; // for
+            }
+        }
+
+        if (LineCount == 0) { // End of file
+            break; // while
+        }
+
+        // Evaluate batch (positions are sharded across threads)
+
+#pragma omp parallel for schedule(dynamic, 64) private(ThreadBoard, InCheck)
+        for (int Index = 0; Index < LineCount; ++Index) {
+            Valid[Index] = ReadPositionFen(Lines + Index * EVALUATE_MAX_LINE_LENGTH, Fens + Index * MAX_FEN_LENGTH);
+
+            if (!Valid[Index]) {
+                continue; // Next position
+            }
+
+            ThreadBoard = &ThreadBoardList[omp_get_thread_num()];
+
+            SetFen(ThreadBoard, Fens + Index * MAX_FEN_LENGTH); // With InitAccumulator
+
+            StaticScores[Index] = Evaluate(ThreadBoard);
+
+            if (SearchDepth >= 0) {
+                InCheck = IsInCheck(ThreadBoard, ThreadBoard->CurrentColor);
+
+                if (SearchDepth == 0) {
+                    ThreadBoard->Nodes = 0ULL;
+
+                    ThreadBoard->SelDepth = 0;
+
+                    SearchScores[Index] = QuiescenceSearch(ThreadBoard, -INF, INF, 0, 0, TRUE, InCheck);
                 }
+                else {
+                    SearchScores[Index] = SearchIterative(ThreadBoard, SearchDepth, 0ULL, 0ULL, InCheck, NULL, NULL);
+                }
+            }
+        }
+
+        // Write batch (in file order)
+
+        for (int Index = 0; Index < LineCount; ++Index) {
+            if (!Valid[Index]) {
+                continue; // Next position
             }
 
-            ++Part;
-        } // while
+            Line = Lines + Index * EVALUATE_MAX_LINE_LENGTH;
+
+            Part = Line + strlen(Line);
+
+            while (Part > Line && (Part[-1] == '\r' || Part[-1] == '\n' || Part[-1] == ' ')) {
+                --Part;
+            }
+
+            *Part = '\0'; // Nul
+
+            if (SearchDepth >= 0) {
+                fprintf(FileOut, "%s|%d|%d\n", Line, StaticScores[Index], SearchScores[Index]); // Scores for the side to move
+            }
+            else {
+                fprintf(FileOut, "%s|%d\n", Line, StaticScores[Index]); // Score for the side to move
+            }
+
+            ++PositionCount;
+        }
+
+        printf("Positions = %llu\n", PositionCount);
     } // while
 
-    printf("Game number = %d\n", GameNumber - 1);
+    EvaluateTime = Clock() - EvaluateTimeStart;
+
+    omp_set_num_threads(SavedThreads);
+
+    printf("\n");
+
+    printf("Positions = %llu (%s) Time = %.2f sec.", PositionCount, FileOutName, (double)EvaluateTime / 1000.0);
+
+    if (EvaluateTime > 0ULL) {
+        printf(" Positions/sec. = %llu", 1000ULL * PositionCount / EvaluateTime);
+    }
+
+    printf("\n");
+
+Done:
+
+    free(SearchScores);
+    free(StaticScores);
+
+    free(Valid);
+
+    free(Fens);
+    free(Lines);
 
     fclose(FileOut);
     fclose(FileIn);
 
     printf("\n");
 
-    printf("Convert PGN file to FEN file...DONE\n");
+    printf("Evaluate positions from file...DONE\n");
 }
\ No newline at end of file
@@ -5,8 +5,73 @@
 #ifndef TUNING_H
 #define TUNING_H
 
+#include "Board.h"
 #include "Def.h"
+#include "Types.h"
+
+#define PACKED_SCORE        1       // Search score is set
+
+#define PACKED_BUFFER_SIZE  65536   // Positions (2 Mb)
+
+#define DATA_FILE_NAME          "selfplay.bin"
+
+#define DATA_DEFAULT_GAMES      1000
+#define DATA_DEFAULT_DEPTH      8
+
+#define DATA_BOOK_PLY           24      // Max. book moves in the opening
+#define DATA_RANDOM_PLY         8       // Random moves after the book moves
+
+#define DATA_MAX_PLY            400     // Draw if the game is longer
+
+#define DATA_HASH_TABLE_SIZE    16      // Mb (own hash table of the thread, cleared for each game)
+
+#define DATA_WIN_SCORE          1000    // Win adjudication: score >= DATA_WIN_SCORE during DATA_WIN_PLY plies
+#define DATA_WIN_PLY            4
+
+#define DATA_DRAW_START_PLY     80      // Draw adjudication: abs(score) <= DATA_DRAW_SCORE during DATA_DRAW_PLY plies
+#define DATA_DRAW_SCORE         10
+#define DATA_DRAW_PLY           12
+
+#define EVALUATE_BATCH_SIZE         65536   // Positions
+#define EVALUATE_MAX_LINE_LENGTH    512
+
+typedef struct {
+    U64 Occupied;           // Occupied squares
+    U8 Pieces[16];          // (Color << 3) | Piece (4 bits) of occupied squares in square order (low nibble first)
+
+    U8 CurrentColor;
+    U8 CastleFlags;
+    I8 PassantSquare;       // -1 if none
+    U8 FiftyMove;
+
+    I8 Result;              // 1 = white win, 0 = draw, -1 = black win
+    U8 Flags;               // PACKED_SCORE
+    I16 Score;              // Search score (white)
+} PackedPositionItem; // 32 bytes
+
+typedef struct {
+    FILE* File;
+
+    int Count;
+    int Index;
+
+    PackedPositionItem* Position; // [PACKED_BUFFER_SIZE]
+} PackedReaderItem;
+
+void PackPosition(const BoardItem* Board, const int Result, const int Score, const int Flags, PackedPositionItem* Position);
+void UnpackPosition(BoardItem* Board, const PackedPositionItem* Position);
+
+BOOL OpenPackedReader(PackedReaderItem* Reader, const char* FileName);
+const PackedPositionItem* ReadPackedPosition(PackedReaderItem* Reader, BoardItem* Board);
+void ClosePackedReader(PackedReaderItem* Reader);
 
 void Pgn2Fen(void);
+void Pgn2Packed(void);
+
+void GenerateData(void);
+
+BOOL ReadPositionFen(const char* Line, char* Fen);
+
+void EvaluateFile(const char* FileInName, const char* FileOutName, const int SearchDepth);
 
 #endif // !TUNING_H
\ No newline at end of file
@@ -21,7 +21,7 @@ typedef __int64             I64;
 
 typedef unsigned __int8     U8;
 typedef unsigned __int16    U16;
-//typedef unsigned __int32    U32;
+typedef unsigned __int32    U32;
 typedef unsigned __int64    U64;
 
 #endif // !TYPES_H
\ No newline at end of file
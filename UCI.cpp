@@ -12,14 +12,169 @@
 #include "Hash.h"
 #include "Move.h"
 #include "NNUE2.h"
+#include "Polyglot.h"
+#include "Statistic.h"
+#include "Trace.h"
 #include "Types.h"
 #include "Utils.h"
 
+// Command queue (input thread -> main thread)
+
+char CommandQueue[UCI_COMMAND_QUEUE_SIZE][UCI_COMMAND_LENGTH];
+U64 CommandTime[UCI_COMMAND_QUEUE_SIZE]; // Command is read
+
+int CommandHead;    // Next command to be processed
+int CommandTail;    // Next command to be read
+int CommandPending; // Commands in queue or in process
+
+SRWLOCK CommandLock = SRWLOCK_INIT;
+CONDITION_VARIABLE CommandReady = CONDITION_VARIABLE_INIT;
+CONDITION_VARIABLE CommandFree = CONDITION_VARIABLE_INIT;
+
+// Auto reduce time (move overhead)
+
+BOOL AutoReduceTime = FALSE;
+
+U64 ReduceTimeSample[REDUCE_TIME_SAMPLES]; // Milliseconds (the last moves)
+int ReduceTimeSampleCount;
+
+int ReduceTimeCompare(const void* Sample1, const void* Sample2)
+{
+    U64 Time1 = *(U64*)Sample1;
+    U64 Time2 = *(U64*)Sample2;
+
+    if (Time1 < Time2) {
+        return -1;
+    }
+
+    if (Time1 > Time2) {
+        return 1;
+    }
+
+    return 0;
+}
+
+void AddReduceTimeSample(const I64 Sample) // Reduce time = percentile of the last moves + margin
+{
+    U64 SortedSample[REDUCE_TIME_SAMPLES];
+    int SampleCount;
+
+    U64 NewReduceTime;
+
+    if (Sample < -(I64)MAX_REDUCE_TIME || Sample > (I64)MAX_REDUCE_TIME) { // New time control (moves to go) or clock changed by the GUI
+        return;
+    }
+
+    ReduceTimeSample[ReduceTimeSampleCount++ % REDUCE_TIME_SAMPLES] = (U64)MAX(Sample, 0LL);
+
+    SampleCount = MIN(ReduceTimeSampleCount, REDUCE_TIME_SAMPLES);
+
+    if (SampleCount < REDUCE_TIME_MIN_SAMPLES) {
+        return;
+    }
+
+    memcpy(SortedSample, ReduceTimeSample, SampleCount * sizeof(U64));
+
+    qsort(SortedSample, SampleCount, sizeof(U64), ReduceTimeCompare);
+
+    NewReduceTime = SortedSample[(SampleCount - 1) * REDUCE_TIME_PERCENTILE / 100] + (U64)REDUCE_TIME_MARGIN;
+    NewReduceTime = MIN(NewReduceTime, (U64)MAX_REDUCE_TIME);
+
+    if (NewReduceTime != ReduceTime) {
+        ReduceTime = NewReduceTime;
+
+        printf("info string Reduce time %llu ms\n", ReduceTime);
+    }
+}
+
+BOOL ImmediateCommand(const char* Command) // Commands processed during the search
+{
+    if (strncmp(Command, "isready", 7) == 0) {
+        printf("readyok\n");
+
+        return TRUE;
+    }
+
+    if (strncmp(Command, "ponderhit", 9) == 0) {
+        SearchPonderHit();
+
+        return TRUE;
+    }
+
+    if (strncmp(Command, "stop", 4) == 0) {
+        if (TraceRate > 0) {
+            TraceSaveRequest = TRUE; // Saved when the search is finished
+        }
+
+        SearchStop();
+
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+void InputThread(void* ignored)
+{
+    char Buf[UCI_COMMAND_LENGTH];
+
+    U64 ReadTime;
+
+    BOOL Quit = FALSE;
+
+    while (!Quit) {
+        if (fgets(Buf, sizeof(Buf), stdin) == NULL) { // End of input
+            strcpy_s(Buf, sizeof(Buf), "quit\n");
+        }
+
+        ReadTime = Clock();
+
+        if (Buf[0] == '\r' || Buf[0] == '\n') { // Empty line
+            continue; // Next command
+        }
+
+        Quit = (strncmp(Buf, "quit", 4) == 0);
+
+        AcquireSRWLockExclusive(&CommandLock);
+
+        // "isready", "stop" and "ponderhit" are processed at once (not waiting for the search); in order with other commands otherwise
+
+        if (CommandPending > 0 || !ImmediateCommand(Buf)) {
+            while (CommandTail - CommandHead == UCI_COMMAND_QUEUE_SIZE) { // Queue is full
+                SleepConditionVariableSRW(&CommandFree, &CommandLock, INFINITE, 0);
+            }
+
+            strcpy_s(CommandQueue[CommandTail & (UCI_COMMAND_QUEUE_SIZE - 1)], UCI_COMMAND_LENGTH, Buf);
+
+            CommandTime[CommandTail & (UCI_COMMAND_QUEUE_SIZE - 1)] = ReadTime;
+
+            ++CommandTail;
+            ++CommandPending;
+
+            WakeConditionVariable(&CommandReady);
+        }
+
+        ReleaseSRWLockExclusive(&CommandLock);
+    }
+
+    _endthread();
+}
+
 void UCI(void)
 {
-    char Buf[4096];
+    char Buf[UCI_COMMAND_LENGTH];
     char* Part;
 
+    U64 ReadTime;
+
+    char LastPosition[UCI_COMMAND_LENGTH] = ""; // "position" of the current board ("" = not used)
+    size_t LastPositionLength;
+
+    char* Position;
+
+    char* NewMoves;
+    int NewMoveCount;
+
     int File;
     int Rank;
 
@@ -33,17 +188,24 @@ void UCI(void)
     BOOL MoveInCheck;
 
     int GenMoveCount;
-    MoveItem MoveList[MAX_GEN_MOVES];
+    MoveListItem MoveList;
 
     int HashSize;
     int Threads;
+    int Rate;
 
     char BookFileNameString[256];
     char* BookFileName;
 
+    char PolyglotFileNameString[256];
+    char* PolyglotFileName;
+
     char NnueFileNameString[256];
     char* NnueFileName;
 
+    char StatisticFileNameString[256];
+    char* StatisticFileName;
+
     U64 WTime;
     U64 BTime;
 
@@ -54,7 +216,18 @@ void UCI(void)
 
     int Mate;
 
-    double Ratio;
+    BOOL Ponder;
+
+    U64 OwnTime;
+    U64 OwnInc;
+
+    U64 ReduceTimeOption = (U64)DEFAULT_REDUCE_TIME;
+
+    BOOL NextMove = FALSE; // "position": the previous position with two new moves (own move and opponent's move)
+
+    U64 LastGoTime = 0ULL; // 0 = auto reduce time is not used for the next move
+    U64 LastGoOwnTime = 0ULL;
+    U64 LastGoOwnInc = 0ULL;
 
     setvbuf(stdin, NULL, _IONBF, 0);
     setvbuf(stdout, NULL, _IONBF, 0);
@@ -65,24 +238,61 @@ void UCI(void)
     printf("option name Hash type spin default %d min %d max %d\n", DEFAULT_HASH_TABLE_SIZE, 1, MAX_HASH_TABLE_SIZE);
     printf("option name Threads type spin default %d min %d max %d\n", DEFAULT_THREADS, 1, MaxThreads);
     printf("option name BookFile type string default %s\n", DEFAULT_BOOK_FILE_NAME);
+    printf("option name PolyglotFile type string default <empty>\n");
     printf("option name NnueFile type string default %s\n", DEFAULT_NNUE_FILE_NAME);
     printf("option name ReduceTime type spin default %d min %d max %d\n", DEFAULT_REDUCE_TIME, 1, MAX_REDUCE_TIME);
+    printf("option name AutoReduceTime type check default false\n");
+    printf("option name Statistic type check default false\n");
+    printf("option name TraceRate type spin default %d min %d max %d\n", 0, 0, TRACE_MAX_RATE);
+    printf("option name Ponder type check default false\n");
 
     SetFen(&CurrentBoard, StartFen);
 
     printf("uciok\n");
 
+    _beginthread(InputThread, 0, NULL);
+
     while (TRUE) {
-        fgets(Buf, sizeof(Buf), stdin);
+        AcquireSRWLockExclusive(&CommandLock);
+
+        while (CommandHead == CommandTail) { // Queue is empty
+            SleepConditionVariableSRW(&CommandReady, &CommandLock, INFINITE, 0);
+        }
+
+        strcpy_s(Buf, sizeof(Buf), CommandQueue[CommandHead & (UCI_COMMAND_QUEUE_SIZE - 1)]);
+
+        ReadTime = CommandTime[CommandHead & (UCI_COMMAND_QUEUE_SIZE - 1)];
+
+        ++CommandHead;
+
+        WakeConditionVariable(&CommandFree);
+
+        ReleaseSRWLockExclusive(&CommandLock);
 
         Part = Buf;
 
-        if (strncmp(Part, "isready", 7) == 0) {
-            printf("readyok\n");
+        if (
+            strncmp(Part, "ucinewgame", 10) == 0
+            || strncmp(Part, "setoption ", 10) == 0
+            || strncmp(Part, "statistic", 9) == 0
+            || strncmp(Part, "position ", 9) == 0
+            || strncmp(Part, "go ", 3) == 0
+            || strncmp(Part, "quit", 4) == 0
+        ) { // The board, the hash table and the options are not changed during the search (the search is stopped)
+            SearchStop();
+            SearchWait();
+        }
+
+        if (ImmediateCommand(Part)) {
+            // "isready", "stop" or "ponderhit" (in order with other commands)
         }
         else if (strncmp(Part, "ucinewgame", 10) == 0) {
             SetFen(&CurrentBoard, StartFen);
 
+            LastPosition[0] = '\0'; // Nul
+
+            LastGoTime = 0ULL;
+
             ClearHashTable();
         }
         else if (strncmp(Part, "setoption name Hash value ", 26) == 0) {
@@ -114,6 +324,24 @@ void UCI(void)
 
             LoadBook(BookFileNameString);
         }
+        else if (strncmp(Part, "setoption name PolyglotFile value ", 34) == 0) {
+            Part += 34;
+
+            PolyglotFileName = PolyglotFileNameString;
+
+            while (*Part != '\r' && *Part != '\n' && *Part != '\0') {
+                *PolyglotFileName++ = *Part++; // Copy file name
+            }
+
+            *PolyglotFileName = '\0'; // Nul
+
+            if (PolyglotFileNameString[0] == '\0' || strcmp(PolyglotFileNameString, "<empty>") == 0) {
+                FreePolyglotBook();
+            }
+            else {
+                LoadPolyglotBook(PolyglotFileNameString);
+            }
+        }
         else if (strncmp(Part, "setoption name NnueFile value ", 30) == 0) {
             Part += 30;
 
@@ -126,114 +354,224 @@ void UCI(void)
             *NnueFileName = '\0'; // Nul
 
             LoadNetwork(NnueFileNameString);
+
+            LastPosition[0] = '\0'; // Nul (the accumulators of the current board are not valid)
         }
         else if (strncmp(Part, "setoption name ReduceTime value ", 32) == 0) {
             Part += 32;
 
-            ReduceTime = (U64)atoi(Part);
-            ReduceTime = (ReduceTime >= 1ULL && ReduceTime <= (U64)MAX_REDUCE_TIME) ? ReduceTime : (U64)DEFAULT_REDUCE_TIME;
+            ReduceTimeOption = (U64)atoi(Part);
+            ReduceTimeOption = (ReduceTimeOption >= 1ULL && ReduceTimeOption <= (U64)MAX_REDUCE_TIME) ? ReduceTimeOption : (U64)DEFAULT_REDUCE_TIME;
+
+            ReduceTime = ReduceTimeOption;
+
+            ReduceTimeSampleCount = 0;
         }
-        else if (strncmp(Part, "position ", 9) == 0) {
-            Part += 9;
+        else if (strncmp(Part, "setoption name AutoReduceTime value ", 36) == 0) {
+            Part += 36;
 
-            if (strncmp(Part, "startpos", 8) == 0) {
-                Part += 8;
+            AutoReduceTime = (strncmp(Part, "true", 4) == 0);
 
-                SetFen(&CurrentBoard, StartFen);
-            }
-            else if (strncmp(Part, "fen ", 4) == 0) {
-                Part += 4;
+            ReduceTime = ReduceTimeOption;
 
-                Part += SetFen(&CurrentBoard, Part);
-            }
+            ReduceTimeSampleCount = 0;
+        }
+        else if (strncmp(Part, "setoption name Statistic value ", 31) == 0) {
+            Part += 31;
+
+            UseStatistic = (strncmp(Part, "true", 4) == 0);
+        }
+        else if (strncmp(Part, "setoption name TraceRate value ", 31) == 0) {
+            Part += 31;
+
+            Rate = atoi(Part);
+            Rate = (Rate >= 0 && Rate <= TRACE_MAX_RATE) ? Rate : 0;
+
+            InitTrace(Rate);
+        }
+        else if (strncmp(Part, "setoption name Ponder value ", 28) == 0) {
+            // Nothing to set ("go ponder")
+        }
+        else if (strncmp(Part, "statistic", 9) == 0) { // Not UCI: statistic of the last search (JSON) [to file]
+            Part += 9;
 
             if (*Part == ' ') {
                 ++Part; // Space
             }
 
-            if (strncmp(Part, "moves ", 6) == 0) {
-                Part += 6;
+            StatisticFileName = StatisticFileNameString;
 
-                while (*Part != '\r' && *Part != '\n' && *Part != '\0') {
-                    // Move (e2e4, e7e8q)
+            while (*Part != '\r' && *Part != '\n' && *Part != '\0') {
+                *StatisticFileName++ = *Part++; // Copy file name
+            }
 
-                    File = Part[0] - 'a';
-                    Rank = 7 - (Part[1] - '1');
+            *StatisticFileName = '\0'; // Nul
 
-                    From = SQUARE_CREATE(File, Rank);
+            if (!UseStatistic) {
+                printf("info string Statistic not used!\n");
+            }
+            else if (StatisticFileNameString[0] == '\0') {
+                PrintStatistic(stdout, &CurrentBoard.Statistic, CurrentBoard.Nodes, TotalTime);
+            }
+            else {
+                SaveStatistic(StatisticFileNameString, &CurrentBoard.Statistic, CurrentBoard.Nodes, TotalTime);
+            }
+        }
+        else if (strncmp(Part, "position ", 9) == 0) {
+            Part += 9;
 
-                    File = Part[2] - 'a';
-                    Rank = 7 - (Part[3] - '1');
+            Part[strcspn(Part, "\r\n")] = '\0'; // End of line
 
-                    To = SQUARE_CREATE(File, Rank);
+            Position = Part;
 
-                    if (Part[4] == 'N' || Part[4] == 'n') {
-                        PromotePieceType = KNIGHT;
+            // The previous position with one or two new moves: the new moves are made on the current board
 
-                        Part += 5;
-                    }
-                    else if (Part[4] == 'B' || Part[4] == 'b') {
-                        PromotePieceType = BISHOP;
+            NewMoves = NULL;
 
-                        Part += 5;
-                    }
-                    else if (Part[4] == 'R' || Part[4] == 'r') {
-                        PromotePieceType = ROOK;
+            LastPositionLength = strlen(LastPosition);
 
-                        Part += 5;
-                    }
-                    else if (Part[4] == 'Q' || Part[4] == 'q') {
-                        PromotePieceType = QUEEN;
+            if (LastPositionLength > 0 && strncmp(Part, LastPosition, LastPositionLength) == 0 && (Part[LastPositionLength] == ' ' || Part[LastPositionLength] == '\0')) {
+                NewMoves = Part + LastPositionLength;
 
-                        Part += 5;
-                    }
-                    else {
-                        PromotePieceType = 0;
+                if (*NewMoves == ' ') {
+                    ++NewMoves; // Space
+                }
+
+                if (strncmp(NewMoves, "moves ", 6) == 0 && strstr(LastPosition, "moves") == NULL) {
+                    NewMoves += 6;
+                }
+
+                NewMoveCount = 0;
 
-                        Part += 4;
+                for (char* MovePart = NewMoves; *MovePart != '\0'; ++MovePart) {
+                    if (*MovePart != ' ' && (MovePart == NewMoves || MovePart[-1] == ' ')) {
+                        ++NewMoveCount;
                     }
+                }
 
-                    Move = MOVE_CREATE(From, To, PromotePieceType);
+                if (NewMoveCount > UCI_MAX_NEW_MOVES) {
+                    NewMoves = NULL; // Full rebuild
+                }
+            }
 
-                    MoveFound = FALSE;
-                    MoveInCheck = FALSE;
+            NextMove = (NewMoves && NewMoveCount == 2);
 
-                    GenMoveCount = 0;
-                    GenerateAllMoves(&CurrentBoard, NULL, MoveList, &GenMoveCount);
+            if (NewMoves) {
+                Part = NewMoves;
+            }
+            else {
+                if (strncmp(Part, "startpos", 8) == 0) {
+                    Part += 8;
 
-                    for (int MoveNumber = 0; MoveNumber < GenMoveCount; ++MoveNumber) {
-                        if (MoveList[MoveNumber].Move == Move) {
-                            MoveFound = TRUE;
+                    SetFen(&CurrentBoard, StartFen);
+                }
+                else if (strncmp(Part, "fen ", 4) == 0) {
+                    Part += 4;
 
-                            MakeMove(&CurrentBoard, MoveList[MoveNumber]);
+                    Part += SetFen(&CurrentBoard, Part);
+                }
 
-                            MoveInCheck = IsInCheck(&CurrentBoard, CHANGE_COLOR(CurrentBoard.CurrentColor));
+                if (*Part == ' ') {
+                    ++Part; // Space
+                }
 
-                            if (MoveInCheck) { // Illegal move
-                                UnmakeMove(&CurrentBoard);
-                            }
+                if (strncmp(Part, "moves ", 6) == 0) {
+                    Part += 6;
+                }
+                else {
+                    Part += strlen(Part); // No moves
+                }
+            }
 
-                            break; // for
-                        }
-                    }
+            MoveFound = TRUE;
+            MoveInCheck = FALSE;
 
-                    if (!MoveFound || MoveInCheck) { // Move not found or illegal move
-                        printf("info string Illegal move (%s%s", BoardName[From], BoardName[To]);
+            while (*Part != '\0') {
+                // Move (e2e4, e7e8q)
 
-                        if (PromotePieceType != 0) {
-                            printf("%c", PiecesCharBlack[PromotePieceType]);
-                        }
+                File = Part[0] - 'a';
+                Rank = 7 - (Part[1] - '1');
+
+                From = SQUARE_CREATE(File, Rank);
+
+                File = Part[2] - 'a';
+                Rank = 7 - (Part[3] - '1');
+
+                To = SQUARE_CREATE(File, Rank);
+
+                if (Part[4] == 'N' || Part[4] == 'n') {
+                    PromotePieceType = KNIGHT;
 
-                        printf(")!\n");
+                    Part += 5;
+                }
+                else if (Part[4] == 'B' || Part[4] == 'b') {
+                    PromotePieceType = BISHOP;
+
+                    Part += 5;
+                }
+                else if (Part[4] == 'R' || Part[4] == 'r') {
+                    PromotePieceType = ROOK;
+
+                    Part += 5;
+                }
+                else if (Part[4] == 'Q' || Part[4] == 'q') {
+                    PromotePieceType = QUEEN;
+
+                    Part += 5;
+                }
+                else {
+                    PromotePieceType = 0;
 
-                        break; // while (moves)
+                    Part += 4;
+                }
+
+                Move = MOVE_CREATE(From, To, PromotePieceType);
+
+                MoveFound = FALSE;
+                MoveInCheck = FALSE;
+
+                GenMoveCount = 0;
+                GenerateAllMoves(&CurrentBoard, NULL, &MoveList, &GenMoveCount);
+
+                for (int MoveNumber = 0; MoveNumber < GenMoveCount; ++MoveNumber) {
+                    if (MoveList.Move[MoveNumber] == Move) {
+                        MoveFound = TRUE;
+
+                        MakeMove(&CurrentBoard, CreateMoveItem(&CurrentBoard, MoveList.Move[MoveNumber]));
+
+                        MoveInCheck = IsInCheck(&CurrentBoard, CHANGE_COLOR(CurrentBoard.CurrentColor));
+
+                        if (MoveInCheck) { // Illegal move
+                            UnmakeMove(&CurrentBoard);
+                        }
+
+                        break; // for
                     }
+                }
+
+                if (!MoveFound || MoveInCheck) { // Move not found or illegal move
+                    printf("info string Illegal move (%s%s", BoardName[From], BoardName[To]);
 
-                    if (*Part == ' ') {
-                        ++Part; // Space
+                    if (PromotePieceType != 0) {
+                        printf("%c", PiecesCharBlack[PromotePieceType]);
                     }
-                } // while
-            } // if
+
+                    printf(")!\n");
+
+                    break; // while (moves)
+                }
+
+                if (*Part == ' ') {
+                    ++Part; // Space
+                }
+            } // while
+
+            if (!MoveFound || MoveInCheck) { // Move not found or illegal move
+                LastPosition[0] = '\0'; // Nul
+            }
+            else {
+                strcpy_s(LastPosition, sizeof(LastPosition), Position);
+            }
         }
         else if (strncmp(Part, "go ", 3) == 0) {
             Part += 3;
@@ -246,13 +584,17 @@ void UCI(void)
 
             MovesToGo = 0;
 
+            Ponder = FALSE;
+
             MaxDepth = 0;
 
             MaxTime = 0ULL;
 
+            MaxNodes = 0ULL;
+
             TimeForMove = 0ULL;
 
-            memset(TargetTime, 0, sizeof(TargetTime));
+            TargetTime = 0ULL;
 
             while (*Part != '\r' && *Part != '\n' && *Part != '\0') {
                 if (strncmp(Part, "wtime ", 6) == 0) {
@@ -297,11 +639,21 @@ void UCI(void)
 
                     MaxTime = (U64)atoi(Part);
                 }
+                else if (strncmp(Part, "nodes ", 6) == 0) {
+                    Part += 6;
+
+                    MaxNodes = strtoull(Part, NULL, 10);
+                }
                 else if (strncmp(Part, "infinite", 8) == 0) {
                     Part += 8;
 
                     MaxTime = 0ULL;
                 }
+                else if (strncmp(Part, "ponder", 6) == 0) {
+                    Part += 6;
+
+                    Ponder = TRUE;
+                }
 
                 while (*Part != ' ' && *Part != '\r' && *Part != '\n' && *Part != '\0') {
                     ++Part;
@@ -312,6 +664,20 @@ void UCI(void)
                 }
             } // while
 
+            // Auto reduce time: the delay of the previous move (GUI clock or "bestmove" output) over the search time
+
+            OwnTime = (CurrentBoard.CurrentColor == WHITE) ? WTime : BTime;
+            OwnInc = (CurrentBoard.CurrentColor == WHITE) ? WInc : BInc;
+
+            if (AutoReduceTime && LastGoTime > 0ULL) {
+                if (NextMove && LastGoOwnTime > 0ULL && OwnTime > 0ULL) { // Time of the previous move by the GUI clock
+                    AddReduceTimeSample((I64)(LastGoOwnTime + LastGoOwnInc) - (I64)OwnTime - (I64)TotalTime);
+                }
+                else { // From "go" to "bestmove"
+                    AddReduceTimeSample((I64)BestMoveTime - (I64)LastGoTime - (I64)TotalTime);
+                }
+            }
+
             if (MovesToGo < 1 || MovesToGo > MAX_MOVES_TO_GO) {
                 MovesToGo = MAX_MOVES_TO_GO;
             }
@@ -331,11 +697,7 @@ void UCI(void)
 
                     TimeForMove = (MaxTime / (U64)MovesToGo) + WInc;
 
-                    for (int Step = 0; Step < MAX_TIME_STEPS; ++Step) {
-                        Ratio = MIN_TIME_RATIO + Step * (MAX_TIME_RATIO - MIN_TIME_RATIO) / (MAX_TIME_STEPS - 1);
-
-                        TargetTime[Step] = MIN((U64)(Ratio * (double)TimeForMove), MaxTime);
-                    }
+                    TargetTime = MIN(TimeForMove, MaxTime);
 
                     MaxTime = MIN(((MaxTime / (U64)MIN(MovesToGo, MAX_TIME_MOVES_TO_GO)) + WInc), MaxTime);
                 }
@@ -349,11 +711,7 @@ void UCI(void)
 
                     TimeForMove = (MaxTime / (U64)MovesToGo) + BInc;
 
-                    for (int Step = 0; Step < MAX_TIME_STEPS; ++Step) {
-                        Ratio = MIN_TIME_RATIO + Step * (MAX_TIME_RATIO - MIN_TIME_RATIO) / (MAX_TIME_STEPS - 1);
-
-                        TargetTime[Step] = MIN((U64)(Ratio * (double)TimeForMove), MaxTime);
-                    }
+                    TargetTime = MIN(TimeForMove, MaxTime);
 
                     MaxTime = MIN(((MaxTime / (U64)MIN(MovesToGo, MAX_TIME_MOVES_TO_GO)) + BInc), MaxTime);
                 }
@@ -376,28 +734,29 @@ void UCI(void)
 
             if (!IsHashTableInitialized()) {
                 printf("info string Hash table not initialized!\n");
-
-                continue; // Next command
             }
-
-            if (!IsNetworkLoaded()) {
+            else if (!IsNetworkLoaded()) {
                 printf("info string Network not loaded!\n");
-
-                continue; // Next command
             }
+            else {
+                LastGoTime = Ponder ? 0ULL : ReadTime; // Pondering: the GUI clock is started by "ponderhit"
+                LastGoOwnTime = OwnTime;
+                LastGoOwnInc = OwnInc;
 
-            _beginthread(ComputerMoveThread, 0, NULL);
-        }
-        else if (strncmp(Part, "stop", 4) == 0) {
-            StopSearch = TRUE;
+                SearchStart(Ponder);
+            }
         }
         else if (strncmp(Part, "quit", 4) == 0) {
-            StopSearch = TRUE;
-
-            return;
+            return; // The search is stopped
         }
         else {
             printf("info string Unknown command!\n");
         }
+
+        AcquireSRWLockExclusive(&CommandLock);
+
+        --CommandPending;
+
+        ReleaseSRWLockExclusive(&CommandLock);
     } // while
 }
\ No newline at end of file
@@ -7,6 +7,11 @@
 
 #include "Def.h"
 
+#define UCI_COMMAND_QUEUE_SIZE  64      // Commands (power of 2)
+#define UCI_COMMAND_LENGTH      4096
+
+#define UCI_MAX_NEW_MOVES       2       // "position ... moves": moves made on the current board (full rebuild otherwise)
+
 void UCI(void);
 
 #endif // !UCI_H
\ No newline at end of file
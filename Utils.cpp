@@ -15,16 +15,25 @@ int ThreadNode[MAX_THREADS];
 
 U64 RandState = 0ULL; // The state can be seeded with any value
 
+U64 ClockFrequency = 0ULL; // Performance counter ticks per second
+
 /*
-    Time in milliseconds since midnight (00:00:00), January 1, 1970, coordinated universal time (UTC)
+    Time in milliseconds from the performance counter (monotonic: not changed by the system time adjustments)
 */
 U64 Clock(void)
 {
-    struct _timeb timebuffer;
+    LARGE_INTEGER Frequency;
+    LARGE_INTEGER Counter;
+
+    if (ClockFrequency == 0ULL) { // The frequency is fixed at system boot
+        QueryPerformanceFrequency(&Frequency);
+
+        ClockFrequency = (U64)Frequency.QuadPart;
+    }
 
-    _ftime_s(&timebuffer);
+    QueryPerformanceCounter(&Counter);
 
-    return timebuffer.time * 1000ULL + (U64)timebuffer.millitm;
+    return ((U64)Counter.QuadPart / ClockFrequency) * 1000ULL + ((U64)Counter.QuadPart % ClockFrequency) * 1000ULL / ClockFrequency;
 }
 
 /*
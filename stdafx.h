@@ -21,9 +21,8 @@
 //#include <profileapi.h>         // QueryPerformanceCounter(), QueryPerformanceFrequency()
 
 #include <stdio.h>              // _IONBF, printf(), scanf_s(), fopen_s(), fseek(), ftell(), fclose(), fprintf(), fgets(), sprintf_s()
-#include <stdlib.h>             // _countof(), atoi(), strtoull(), malloc(), realloc(), calloc(), free(), qsort()
+#include <stdlib.h>             // _countof(), _byteswap_uint64(), _byteswap_ushort(), atoi(), strtoull(), malloc(), realloc(), calloc(), free(), qsort(), _aligned_malloc(), _aligned_free()
 #include <string.h>             // strcmp(), strncmp(), strchr(), strstr(), strcpy_s()
-#include <sys/timeb.h>          // _timeb, _ftime_s()
 #include <process.h>            // _beginthread(), _endthread()
 #include <omp.h>                // Open MP
 #include <intrin.h>             // __popcnt64(), _BitScanForward64(), _BitScanReverse64(), _mm_prefetch()
@@ -32,5 +31,6 @@
 #include <float.h>              // FLT_MAX
 #include <math.h>               // round(), pow(), log()
 #include <assert.h>             // assert()
+#include <signal.h>             // signal(), SIGBREAK
 
 #endif // !STDAFX_H
\ No newline at end of file